@@ -0,0 +1,173 @@
+/** \file calibration_cache.hpp
+ * @brief Persistent cache of the extrinsic calibration.
+ *
+ * Corner detection, solvePnP, the plane transform and the fused remap table
+ * depend only on the camera pose (and intrinsics), which does not change
+ * between runs unless the camera is moved. Results are stored in the
+ * configuration folder together with a perceptual hash of the frame they were
+ * computed on (see ImageHash::dHash); on the next start they are reused when
+ * the new first frame hashes close enough and the intrinsics are the same.
+ * The hash of a 9x8 thumbnail does not see a camera bumped by a few pixels,
+ * so a hit must also find the arena corners again, inside small windows
+ * around the cached ones, where they were on the calibration frame.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "opencv2/core.hpp"
+#include "image_hash.hpp"
+#include "rectification.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <initializer_list>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//! Extrinsic calibration cache
+namespace CalibrationCache {
+
+/** Cached calibration results. */
+struct Entry {
+    uint64_t hash = 0;                  ///< dHash of the calibration frame.
+    cv::Size size;                      ///< Calibration frame size.
+    cv::Mat cameraMatrix;               ///< Intrinsics used for the calibration.
+    std::vector<cv::Point2f> corners;   ///< Arena corners (pixels).
+    cv::Mat rvec;                       ///< Rotation vector.
+    cv::Mat tvec;                       ///< Translation vector.
+    cv::Mat planeTransf;                ///< Plane transform (empty until computed).
+    cv::Mat distCoeffs;                 ///< Distortion coefficients of the stored remap table.
+    double cornerThreshold = 0;         ///< Arena gray level threshold of the calibration frame.
+    std::vector<cv::Point2f> checkCorners; ///< Corners refined on the calibration frame
+                                        ///< (see CornerDetection::refineCorners;
+                                        ///< empty: never reused).
+
+    /** Checks whether the entry can be used for a new frame.
+     * @param frameHash dHash of the new frame
+     * @param frameSize size of the new frame
+     * @param camMatrix current camera matrix
+     * @param maxDistance maximum hash Hamming distance
+     * @return true if the cached calibration is still valid
+    */
+    bool matches(uint64_t frameHash, const cv::Size& frameSize,
+                 const cv::Mat& camMatrix, int maxDistance) const {
+        return !rvec.empty() && (size == frameSize) &&
+               Rectification::sameMatrix(cameraMatrix, camMatrix) &&
+               (ImageHash::hamming(hash, frameHash) <= maxDistance);
+    }
+
+    /** Checks the corners found again on a new frame.
+     * @param checked corners refined around corners on the new frame
+     * @param maxShift maximum distance (pixels) from checkCorners
+     * @return true if every corner is still in place
+    */
+    bool cornersMatch(const std::vector<cv::Point2f>& checked, float maxShift) const {
+        if ((checkCorners.size() != corners.size()) || (checked.size() != corners.size()))
+            return false;
+        for (size_t i = 0; i < checked.size(); ++i)
+            if (cv::norm(checked[i] - checkCorners[i]) > maxShift)
+                return false;
+        return true;
+    }
+};
+
+/** Loads a cache entry.
+ * @param path cache file path (YAML)
+ * @param entry output entry
+ * @return false if the file does not exist or is not valid
+*/
+bool load(const std::string& path, Entry& entry) {
+    cv::FileStorage fs;
+    try {
+        if (!fs.open(path, cv::FileStorage::READ))
+            return false;
+        std::string hash;
+        fs["hash"] >> hash;
+        std::istringstream(hash) >> std::hex >> entry.hash;
+        int w = 0, h = 0;
+        fs["width"] >> w;
+        fs["height"] >> h;
+        entry.size = cv::Size(w, h);
+        fs["camera_matrix"] >> entry.cameraMatrix;
+        fs["corners"] >> entry.corners;
+        fs["rvec"] >> entry.rvec;
+        fs["tvec"] >> entry.tvec;
+        fs["plane_transf"] >> entry.planeTransf;
+        fs["dist_coeffs"] >> entry.distCoeffs;
+        fs["corner_threshold"] >> entry.cornerThreshold;
+        fs["check_corners"] >> entry.checkCorners;
+    } catch (const cv::Exception&) {
+        return false;
+    }
+    return !entry.rvec.empty() && !entry.tvec.empty() && (entry.corners.size() == 4);
+}
+
+/** Saves a cache entry.
+ * @param path cache file path (YAML)
+ * @param entry entry to save
+*/
+void save(const std::string& path, const Entry& entry) {
+    cv::FileStorage fs(path, cv::FileStorage::WRITE);
+    if (!fs.isOpened())
+        throw std::runtime_error("Cannot write file: " + path);
+    std::ostringstream hash;
+    hash << std::hex << entry.hash;
+    fs << "hash" << hash.str();
+    fs << "width" << entry.size.width;
+    fs << "height" << entry.size.height;
+    fs << "camera_matrix" << entry.cameraMatrix;
+    fs << "corners" << entry.corners;
+    fs << "rvec" << entry.rvec;
+    fs << "tvec" << entry.tvec;
+    fs << "plane_transf" << entry.planeTransf;
+    fs << "dist_coeffs" << entry.distCoeffs;
+    fs << "corner_threshold" << entry.cornerThreshold;
+    fs << "check_corners" << entry.checkCorners;
+}
+
+/** Saves a fixed-point remap table in binary form.
+ * @param path table file path
+ * @param table table to save
+*/
+void saveTable(const std::string& path, const Rectification::RemapTable& table) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open())
+        throw std::runtime_error("Cannot write file: " + path);
+    const int32_t header[4] = { table.map1.rows, table.map1.cols,
+                                table.map1.type(), table.map2.type() };
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    for (const cv::Mat* m : { &table.map1, &table.map2 })
+        for (int y = 0; y < m->rows; ++y)
+            out.write(reinterpret_cast<const char*>(m->ptr(y)), m->cols * m->elemSize());
+}
+
+/** Loads a fixed-point remap table.
+ * @param path table file path
+ * @param size expected table size
+ * @param table output table
+ * @return false if the file does not exist or does not match
+*/
+bool loadTable(const std::string& path, const cv::Size& size, Rectification::RemapTable& table) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open())
+        return false;
+    int32_t header[4];
+    if (!in.read(reinterpret_cast<char*>(header), sizeof(header)))
+        return false;
+    if ((header[0] != size.height) || (header[1] != size.width) ||
+        (header[2] != CV_16SC2) || (header[3] != CV_16UC1))
+        return false;
+    Rectification::RemapTable t;
+    t.map1.create(size, CV_16SC2);
+    t.map2.create(size, CV_16UC1);
+    for (cv::Mat* m : { &t.map1, &t.map2 })
+        if (!in.read(reinterpret_cast<char*>(m->data), m->total() * m->elemSize()))
+            return false;
+    table = t;
+    return true;
+}
+
+}   // namespace CalibrationCache
@@ -0,0 +1,268 @@
+/** \file camera_pipeline.hpp
+ * @brief Asynchronous multi-stage frame pipeline.
+ *
+ * Every stage runs on its own thread; stages are connected by latest-frame
+ * slots, so a slow stage never blocks the producer (the camera callback) nor
+ * the stages before it. Stale frames are dropped: a frame waiting in a slot
+ * is replaced by the next one, so a stage always processes the newest frame
+ * available. Idle stages sleep on a condition variable until a frame
+ * arrives. The output of the last stage is published to a latest-item
+ * mailbox.
+ * Per-stage latency and drops are collected for profiling.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//! Asynchronous pipeline utilities
+namespace CameraPipeline {
+
+typedef std::chrono::steady_clock Clock;    ///< Clock used for latencies.
+
+/** Single item slot keeping only the newest item.
+ * put never waits for the consumer: an item not taken yet is replaced.
+*/
+template <typename T>
+class LatestSlot {
+public:
+    /** Stores an item, replacing the one not taken yet (producer thread).
+     * @param item item to move into the slot
+     * @return false if an item not taken yet was replaced
+    */
+    bool put(T& item) {
+        bool replaced;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            replaced = full;
+            value = std::move(item);
+            full = true;
+        }
+        cond.notify_one();
+        return !replaced;
+    }
+
+    /** Waits for an item (consumer thread).
+     * @param item output item
+     * @return false if the slot was closed
+    */
+    bool take(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [this] { return full || closed; });
+        if (closed)
+            return false;
+        item = std::move(value);
+        full = false;
+        return true;
+    }
+
+    /** Closes the slot: the pending item is discarded and take returns false. */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        cond.notify_all();
+    }
+
+private:
+    std::mutex mutex;               ///< Protects the slot.
+    std::condition_variable cond;   ///< Signals a new item or the closing.
+    T value;                        ///< Pending item.
+    bool full = false;              ///< value was not taken yet.
+    bool closed = false;            ///< The slot was closed.
+};
+
+/** Statistics of a pipeline stage. */
+struct StageStats {
+    std::string name;           ///< Stage name.
+    uint64_t processed = 0;     ///< Frames processed.
+    uint64_t replaced = 0;      ///< Stale frames replaced in the input slot before being processed.
+    uint64_t dropped = 0;       ///< Frames dropped by the stage body.
+    double meanMs = 0;          ///< Mean processing time.
+    double maxMs = 0;           ///< Maximum processing time.
+};
+
+/** Statistics of the whole pipeline. */
+struct PipelineStats {
+    std::vector<StageStats> stages;     ///< Per-stage statistics.
+    uint64_t pushed = 0;                ///< Frames pushed by the producer.
+    uint64_t published = 0;             ///< Frames that reached the output.
+    double meanLatencyMs = 0;           ///< Mean push-to-output latency.
+    double maxLatencyMs = 0;            ///< Maximum push-to-output latency.
+};
+
+/** Multi-stage pipeline, one thread per stage.
+ * A stage returns false to drop the frame (e.g. nothing found).
+*/
+template <typename T>
+class Pipeline {
+public:
+    typedef std::function<bool(T&)> Stage;  ///< Stage body, works in place.
+
+    /** Starts the stage threads.
+     * @param stages named stage bodies, in execution order
+    */
+    explicit Pipeline(const std::vector<std::pair<std::string, Stage>>& stages)
+        : running(true), nextSeq(0), outSeq(0) {
+        if (stages.empty())
+            throw std::invalid_argument("Pipeline: no stages");
+        for (const auto& s : stages) {
+            bodies.push_back(s.second);
+            inputs.emplace_back(new LatestSlot<Envelope>());
+            stageStats.emplace_back();
+            stageStats.back().name = s.first;
+        }
+        for (size_t i = 0; i < bodies.size(); ++i)
+            threads.emplace_back(&Pipeline::stageLoop, this, i);
+    }
+
+    ~Pipeline() { stop(); }
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    /** Stops and joins the stage threads. Pending frames are discarded. */
+    void stop() {
+        running = false;
+        for (auto& input : inputs)
+            input->close();
+        outCond.notify_all();
+        for (std::thread& t : threads)
+            if (t.joinable())
+                t.join();
+    }
+
+    /** Pushes a new frame (single producer thread).
+     * @param item frame to process (moved)
+     * @return false if it replaced a frame not processed yet (the pipeline is behind)
+    */
+    bool push(T item) {
+        Envelope e;
+        e.item = std::move(item);
+        e.seq = ++nextSeq;
+        e.pushed = Clock::now();
+        const bool fresh = inputs[0]->put(e);
+        std::lock_guard<std::mutex> lock(statsMutex);
+        ++totals.pushed;
+        if (!fresh)
+            ++stageStats[0].replaced;
+        return fresh;
+    }
+
+    /** Reads the newest output.
+     * @param item output frame
+     * @return sequence number of the frame (0 if no output is available yet)
+    */
+    uint64_t latest(T& item) const {
+        std::lock_guard<std::mutex> lock(outMutex);
+        if (outSeq != 0)
+            item = out;
+        return outSeq;
+    }
+
+    /** Waits for an output newer than a given sequence number.
+     * @param item output frame
+     * @param after sequence number already consumed
+     * @param timeout maximum wait
+     * @return sequence number of the frame (0 or <= after on timeout)
+    */
+    uint64_t waitNewer(T& item, uint64_t after, std::chrono::milliseconds timeout) const {
+        std::unique_lock<std::mutex> lock(outMutex);
+        outCond.wait_for(lock, timeout, [&] { return (outSeq > after) || !running; });
+        if (outSeq != 0)
+            item = out;
+        return outSeq;
+    }
+
+    /** @return sequence number of the last pushed frame */
+    uint64_t lastPushed() const { return nextSeq; }
+
+    /** @return a snapshot of the statistics */
+    PipelineStats stats() const {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        PipelineStats s = totals;
+        s.stages = stageStats;
+        return s;
+    }
+
+private:
+    /** Frame with its pipeline metadata. */
+    struct Envelope {
+        T item;                 ///< User frame.
+        uint64_t seq = 0;       ///< Push sequence number.
+        Clock::time_point pushed;   ///< Push time.
+    };
+
+    /** Body of the thread of a stage.
+     * @param i stage index
+    */
+    void stageLoop(size_t i) {
+        const bool last = (i + 1 == inputs.size());
+        Envelope e;
+        while (inputs[i]->take(e)) {
+            const Clock::time_point start = Clock::now();
+            const bool keep = bodies[i](e.item);
+            const Clock::time_point end = Clock::now();
+            const uint64_t seq = e.seq;
+            const Clock::time_point pushed = e.pushed;
+
+            if (keep && last) {
+                {
+                    std::lock_guard<std::mutex> lock(outMutex);
+                    out = e.item;
+                    outSeq = seq;
+                }
+                outCond.notify_all();
+            }
+            const bool fresh = !keep || last || inputs[i+1]->put(e);
+
+            std::lock_guard<std::mutex> lock(statsMutex);
+            StageStats& s = stageStats[i];
+            const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+            s.meanMs = (s.meanMs * s.processed + ms) / (s.processed + 1);
+            s.maxMs = std::max(s.maxMs, ms);
+            ++s.processed;
+            if (!keep)
+                ++s.dropped;
+            if (!fresh)
+                ++stageStats[i+1].replaced;
+            if (keep && last) {
+                const double lat = std::chrono::duration<double, std::milli>(end - pushed).count();
+                totals.meanLatencyMs = (totals.meanLatencyMs * totals.published + lat) / (totals.published + 1);
+                totals.maxLatencyMs = std::max(totals.maxLatencyMs, lat);
+                ++totals.published;
+            }
+        }
+    }
+
+    std::vector<Stage> bodies;                          ///< Stage bodies.
+    std::vector<std::unique_ptr<LatestSlot<Envelope>>> inputs; ///< Input slot of every stage.
+    std::vector<std::thread> threads;                   ///< Stage threads.
+    std::atomic<bool> running;                          ///< False when stopping.
+    std::atomic<uint64_t> nextSeq;                      ///< Last pushed sequence number.
+
+    mutable std::mutex outMutex;                        ///< Protects the output mailbox.
+    mutable std::condition_variable outCond;            ///< Signals new outputs.
+    T out;                                              ///< Newest output.
+    uint64_t outSeq;                                    ///< Sequence number of out (0 = none).
+
+    mutable std::mutex statsMutex;                      ///< Protects the statistics.
+    std::vector<StageStats> stageStats;                 ///< Per-stage statistics.
+    PipelineStats totals;                               ///< Pipeline statistics.
+};
+
+}   // namespace CameraPipeline
@@ -0,0 +1,148 @@
+/** \file coarse_detection.hpp
+ * @brief Coarse-to-fine blob detection utilities.
+ *
+ * Blobs of a given color are first located on a decimated copy of the image
+ * (one pixel every 2^levels per side); only the full resolution regions of
+ * interest around them are then thresholded and analyzed. The full resolution
+ * work grows with the number and size of the objects, not with the pixel
+ * count of the camera.
+ *
+ * Decimation uses nearest-neighbour sampling instead of a Gaussian pyramid:
+ * averaging would mix hue values (red wraps around 0/180) and would cost a
+ * full resolution pass.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "opencv2/imgproc.hpp"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+//! Coarse-to-fine detection utilities
+namespace CoarseDetection {
+
+typedef std::pair<cv::Scalar, cv::Scalar> ColorRange; ///< Color lower and upper bounds.
+
+/** Decimation factor of a pyramid level.
+ * @param levels number of pyramid levels
+ * @return side decimation factor (2^levels)
+*/
+int levelFactor(int levels) {
+    return 1 << levels;
+}
+
+/** Decimates an image.
+ * @param img input image
+ * @param levels number of pyramid levels
+ * @param out output image, 2^levels times smaller per side
+*/
+void downsample(const cv::Mat& img, int levels, cv::Mat& out) {
+    const int f = levelFactor(levels);
+    cv::resize(img, out, cv::Size(std::max(1, img.cols / f), std::max(1, img.rows / f)),
+               0, 0, cv::INTER_NEAREST);
+}
+
+/** Merges overlapping rectangles until no pair overlaps.
+ * @param rects rectangles to merge (modified in place)
+*/
+void mergeOverlapping(std::vector<cv::Rect>& rects) {
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; (i < rects.size()) && !merged; ++i) {
+            for (size_t j = i+1; j < rects.size(); ++j) {
+                if ((rects[i] & rects[j]).area() > 0) {
+                    rects[i] |= rects[j];
+                    rects.erase(rects.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/** Thresholds an image with the union of several color ranges.
+ * @param img input image
+ * @param ranges color ranges
+ * @param mask output binary mask
+*/
+void rangesMask(const cv::Mat& img, const std::vector<ColorRange>& ranges, cv::Mat& mask) {
+    mask = cv::Mat::zeros(img.size(), CV_8UC1);
+    cv::Mat range_mask;
+    for (const ColorRange& r : ranges) {
+        cv::inRange(img, r.first, r.second, range_mask);
+        mask |= range_mask;
+    }
+}
+
+/** Finds the full resolution ROIs of the blobs in a decimated image.
+ * @param coarse decimated image (same color space as the ranges)
+ * @param ranges color ranges of the blobs
+ * @param levels number of pyramid levels of the decimated image
+ * @param padding ROI padding in full resolution pixels
+ * @param full_size size of the full resolution image
+ * @return non overlapping full resolution ROIs
+*/
+std::vector<cv::Rect> coarseBlobROIs(const cv::Mat& coarse,
+                                     const std::vector<ColorRange>& ranges,
+                                     int levels, int padding,
+                                     const cv::Size& full_size) {
+    const int f = levelFactor(levels);
+    cv::Mat mask;
+    rangesMask(coarse, ranges, mask);
+
+    std::vector<std::vector<cv::Point>> contours;
+    cv::findContours(mask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+
+    const cv::Rect frame(cv::Point(0, 0), full_size);
+    std::vector<cv::Rect> rois;
+    for (const std::vector<cv::Point>& contour : contours) {
+        cv::Rect r = cv::boundingRect(contour);
+        // one coarse pixel stands for f full resolution pixels
+        cv::Rect full(r.x * f - padding - f, r.y * f - padding - f,
+                      r.width * f + 2 * (padding + f), r.height * f + 2 * (padding + f));
+        full &= frame;
+        if (full.area() > 0)
+            rois.push_back(full);
+    }
+    mergeOverlapping(rois);
+    return rois;
+}
+
+/** Finds the full resolution ROIs of the blobs of an image.
+ * @param img full resolution image (same color space as the ranges)
+ * @param ranges color ranges of the blobs
+ * @param levels number of pyramid levels (0 returns the whole frame)
+ * @param padding ROI padding in full resolution pixels
+ * @return non overlapping full resolution ROIs
+*/
+std::vector<cv::Rect> blobROIs(const cv::Mat& img, const std::vector<ColorRange>& ranges,
+                               int levels, int padding) {
+    if (levels <= 0)
+        return {cv::Rect(0, 0, img.cols, img.rows)};
+    cv::Mat coarse;
+    downsample(img, levels, coarse);
+    return coarseBlobROIs(coarse, ranges, levels, padding, img.size());
+}
+
+/** Finds the full resolution ROIs of the blobs inside some areas of an image.
+ * @param img full resolution image (same color space as the ranges)
+ * @param ranges color ranges of the blobs
+ * @param levels number of pyramid levels (0 returns the areas themselves)
+ * @param padding ROI padding in full resolution pixels
+ * @param areas non overlapping areas to search
+ * @return non overlapping full resolution ROIs, each inside one area
+*/
+std::vector<cv::Rect> blobROIs(const cv::Mat& img, const std::vector<ColorRange>& ranges,
+                               int levels, int padding, const std::vector<cv::Rect>& areas) {
+    std::vector<cv::Rect> rois;
+    for (const cv::Rect& area : areas)
+        for (const cv::Rect& r : blobROIs(img(area), ranges, levels, padding))
+            rois.push_back(r + area.tl());
+    return rois;
+}
+
+}   // namespace CoarseDetection
@@ -0,0 +1,188 @@
+/** \file collision_checker.hpp
+ * @brief Point and segment collision checks shared by the point planners.
+ *
+ * The checker holds the edges of the arena borders and of the obstacles, each
+ * with its bounding box, so most edges are rejected by a box test before the
+ * exact intersection test. The intersection test is the same used by
+ * isSegmentColliding in the student interface.
+ *
+ * polygon refers to the Polygon objects from the AppliedRoboticsEnvironment(*).
+ *
+ * (*)  https://github.com/ValerioMa/AppliedRoboticsEnvironment/blob/master/src/9_project_interface/include/utils.hpp
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+//! Point path planning
+namespace Planning {
+
+/** Euclidean distance of two points.
+ * @param a first point
+ * @param b second point
+ * @return the distance
+*/
+float distance(const Point& a, const Point& b) {
+    return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+/** Checks if two segments intersect (parallel segments never do).
+ * @param a1 first point of the first segment
+ * @param a2 second point of the first segment
+ * @param p1 first point of the second segment
+ * @param p2 second point of the second segment
+ * @return true if the segments intersect
+*/
+bool segmentsIntersect(const Point& a1, const Point& a2, const Point& p1, const Point& p2) {
+    const float determinant = (a2.x - a1.x) * (p1.y - p2.y) - (p1.x - p2.x) * (a2.y - a1.y);
+    if (determinant == 0)
+        return false;
+    const float t = ((a1.y - a2.y) * (p1.x - a1.x) + (a2.x - a1.x) * (p1.y - a1.y)) / determinant;
+    const float u = ((p1.y - p2.y) * (p1.x - a1.x) + (p2.x - p1.x) * (p1.y - a1.y)) / determinant;
+    return (t >= 0) && (t <= 1) && (u >= 0) && (u <= 1);
+}
+
+/** Checks if a point is inside a polygon (ray casting).
+ * @param p point
+ * @param polygon polygon
+ * @return true if p is inside
+*/
+bool insidePolygon(const Point& p, const Polygon& polygon) {
+    bool inside = false;
+    for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+        const Point& a = polygon[i];
+        const Point& b = polygon[j];
+        if (((a.y > p.y) != (b.y > p.y)) &&
+            (p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x))
+            inside = !inside;
+    }
+    return inside;
+}
+
+/** Collision checker of an arena: free space is inside the borders and
+ * outside every obstacle.
+*/
+class CollisionChecker {
+public:
+    /** Builds the edge list.
+     * @param borders arena borders
+     * @param obstacles obstacle polygons
+    */
+    CollisionChecker(const Polygon& borders, const std::vector<Polygon>& obstacles)
+        : borderPolygon(borders), obstacleList(obstacles) {
+        addPolygon(borders);
+        for (const Polygon& obstacle : obstacles)
+            addPolygon(obstacle);
+
+        minX = minY = std::numeric_limits<float>::max();
+        maxX = maxY = std::numeric_limits<float>::lowest();
+        for (const Point& p : borders) {
+            minX = std::min(minX, p.x);
+            minY = std::min(minY, p.y);
+            maxX = std::max(maxX, p.x);
+            maxY = std::max(maxY, p.y);
+        }
+    }
+
+    /** Checks if a point is in free space.
+     * @param p point
+     * @return true if p is inside the borders and outside every obstacle
+    */
+    bool pointFree(const Point& p) const {
+        if (!insidePolygon(p, borderPolygon))
+            return false;
+        for (const Polygon& obstacle : obstacleList)
+            if (insidePolygon(p, obstacle))
+                return false;
+        return true;
+    }
+
+    /** Checks if a segment crosses no border nor obstacle edge.
+     * With free endpoints this means the whole segment is free.
+     * @param a first point
+     * @param b second point
+     * @return true if the segment is free
+    */
+    bool segmentFree(const Point& a, const Point& b) const {
+        const float sMinX = std::min(a.x, b.x), sMaxX = std::max(a.x, b.x);
+        const float sMinY = std::min(a.y, b.y), sMaxY = std::max(a.y, b.y);
+        for (const Edge& e : edges) {
+            if ((e.maxX < sMinX) || (e.minX > sMaxX) || (e.maxY < sMinY) || (e.minY > sMaxY))
+                continue;
+            if (segmentsIntersect(a, b, e.a, e.b))
+                return false;
+        }
+        return true;
+    }
+
+    /** Checks if a segment from a query point is free, ignoring contacts at
+     * the query point itself (e.g. a query point on the borders).
+     * @param query query point
+     * @param p other end of the segment
+     * @return true if the segment is free
+    */
+    bool segmentFreeFrom(const Point& query, const Point& p) const {
+        const float d = distance(query, p);
+        if (d <= QUERY_TOLERANCE)
+            return true;
+        const float f = QUERY_TOLERANCE / d;
+        return segmentFree(Point(query.x + (p.x - query.x) * f, query.y + (p.y - query.y) * f), p);
+    }
+
+    /** Checks if every segment of a path is free.
+     * @param path path vertices
+     * @return true if the path is free
+    */
+    bool pathFree(const std::vector<Point>& path) const {
+        for (size_t i = 1; i < path.size(); ++i)
+            if (!segmentFree(path[i-1], path[i]))
+                return false;
+        return true;
+    }
+
+    const Polygon& borders() const { return borderPolygon; }                ///< Arena borders.
+    const std::vector<Polygon>& obstacles() const { return obstacleList; }  ///< Obstacles.
+    float minXBound() const { return minX; }    ///< Smallest x of the borders.
+    float minYBound() const { return minY; }    ///< Smallest y of the borders.
+    float maxXBound() const { return maxX; }    ///< Largest x of the borders.
+    float maxYBound() const { return maxY; }    ///< Largest y of the borders.
+
+private:
+    /** Edge with its bounding box. */
+    struct Edge {
+        Point a;                ///< First vertex.
+        Point b;                ///< Second vertex.
+        float minX, minY;       ///< Bounding box lower corner.
+        float maxX, maxY;       ///< Bounding box upper corner.
+    };
+
+    /** Adds the edges of a closed polygon.
+     * @param polygon polygon
+    */
+    void addPolygon(const Polygon& polygon) {
+        for (size_t k = 0; k < polygon.size(); ++k) {
+            Edge e;
+            e.a = polygon[k];
+            e.b = polygon[(k + 1) % polygon.size()];
+            e.minX = std::min(e.a.x, e.b.x);
+            e.maxX = std::max(e.a.x, e.b.x);
+            e.minY = std::min(e.a.y, e.b.y);
+            e.maxY = std::max(e.a.y, e.b.y);
+            edges.push_back(e);
+        }
+    }
+
+    static constexpr float QUERY_TOLERANCE = 0.001f;   ///< Ignored contact distance at query points (m).
+
+    Polygon borderPolygon;              ///< Arena borders.
+    std::vector<Polygon> obstacleList;  ///< Obstacles.
+    std::vector<Edge> edges;            ///< Border and obstacle edges.
+    float minX, minY, maxX, maxY;       ///< Bounding box of the borders.
+};
+
+}   // namespace Planning
@@ -3,26 +3,38 @@
 */
 #pragma once
 
+#include "coarse_detection.hpp"
+
 //! Arena corner detection methods
 namespace CornerDetection{
 
 cv::Point findLineCenter(const cv::Mat& img_in, const std::vector<cv::Point> &arena);
 void onMouse(int evt, int x, int y, int flags, void* param);
 void readSelection(const cv::Mat& img_in, std::vector<cv::Point2f>& corners);
+bool refineCorners(const cv::Mat& img_in, double thresh, int radius,
+                   std::vector<cv::Point2f>& corners);
 
 /** Detect automatically the arena corners.
+ * With coarse_levels > 0 the arena is segmented on a frame decimated by
+ * 2^coarse_levels per side and the corners are then refined at full
+ * resolution inside small windows (see refineCorners).
  * @param img_in input image
+ * @param coarse_levels number of pyramid levels of the coarse search (0 = full resolution)
  * @return ordered corners vector
 */
-std::vector<cv::Point2f> autodetect(const cv::Mat& img_in) {
+std::vector<cv::Point2f> autodetect(const cv::Mat& img_in, int coarse_levels = 0) {
     std::vector<cv::Point2f> corners;
 
+    cv::Mat work = img_in;
+    if (coarse_levels > 0)
+        CoarseDetection::downsample(img_in, coarse_levels, work);
+
     // convert to grayscale
     cv::Mat gray;
-    cv::cvtColor(img_in,gray, CV_BGR2GRAY);
+    cv::cvtColor(work,gray, CV_BGR2GRAY);
     // compute mask
     cv::Mat mask;
-    cv::threshold(gray, mask, 120, 255, CV_THRESH_BINARY_INV | CV_THRESH_OTSU);
+    double otsu = cv::threshold(gray, mask, 120, 255, CV_THRESH_BINARY_INV | CV_THRESH_OTSU);
 
     // find contours (if always so easy to segment as your image, you could just add the black/rect pixels to a std::vector)
     std::vector<std::vector<cv::Point>> contours;
@@ -47,7 +59,7 @@ std::vector<cv::Point2f> autodetect(const cv::Mat& img_in) {
     }
 
     #ifdef DEBUG_CORNER_AUTODETECT
-        cv::Mat display = img_in.clone();
+        cv::Mat display = work.clone();
         cv::Scalar color = cv::Scalar(0, 0, 255); // Todo: REMOVE
         cv::drawContours( display, contours,biggestContourIdx , color, 1, 8, hierarchy, 0, cv::Point() );
         cv::imshow("C3",display);
@@ -71,7 +83,7 @@ std::vector<cv::Point2f> autodetect(const cv::Mat& img_in) {
     //
     // Find Red line
     //                /* Red color requires 2 ranges*/
-    cv::Point redLine = findLineCenter(img_in,approx_curve);
+    cv::Point redLine = findLineCenter(work,approx_curve);
     //
     // Find nearestCorner
     //
@@ -94,9 +106,67 @@ std::vector<cv::Point2f> autodetect(const cv::Mat& img_in) {
         corners.emplace_back(approx_curve[index].x,approx_curve[index].y);
     }
 
+    if (coarse_levels > 0) {
+        const int f = CoarseDetection::levelFactor(coarse_levels);
+        for (auto& c : corners)
+            c = cv::Point2f(c.x * f + f / 2.0f, c.y * f + f / 2.0f);
+        refineCorners(img_in, otsu, 2 * f, corners);
+    }
+
     return corners;
 }
 
+/** Refine coarse corners at full resolution.
+ * Every corner is moved to the arena pixel, inside a window around it, that
+ * lies farthest along the direction from the arena center to the corner.
+ * Only the windows are thresholded, with the threshold of the coarse search.
+ * @param img_in full resolution input image
+ * @param thresh gray level threshold (arena is darker)
+ * @param radius window half size in pixels
+ * @param corners corners to refine (modified in place)
+ * @return false if some window holds no arena pixel (that corner is left in place)
+*/
+bool refineCorners(const cv::Mat& img_in, double thresh, int radius,
+                   std::vector<cv::Point2f>& corners) {
+    cv::Point2f center(0, 0);
+    for (const auto& c : corners)
+        center += c;
+    center *= 1.0f / corners.size();
+
+    const cv::Rect frame(0, 0, img_in.cols, img_in.rows);
+    cv::Mat gray, mask;
+    bool found = true;
+    for (auto& c : corners) {
+        cv::Rect window = cv::Rect(cvRound(c.x) - radius, cvRound(c.y) - radius,
+                                   2 * radius + 1, 2 * radius + 1) & frame;
+        if (window.area() == 0) {
+            found = false;
+            continue;
+        }
+        cv::cvtColor(img_in(window), gray, CV_BGR2GRAY);
+        cv::threshold(gray, mask, thresh, 255, CV_THRESH_BINARY_INV);
+
+        const cv::Point2f dir = c - center;
+        float best = -std::numeric_limits<float>::max();
+        cv::Point2f refined = c;
+        for (int y = 0; y < mask.rows; ++y) {
+            const uchar* row = mask.ptr<uchar>(y);
+            for (int x = 0; x < mask.cols; ++x) {
+                if (!row[x]) continue;
+                cv::Point2f p(window.x + x, window.y + y);
+                float d = dir.dot(p - center);
+                if (d > best) {
+                    best = d;
+                    refined = p;
+                }
+            }
+        }
+        found = found && (best > -std::numeric_limits<float>::max());
+        c = refined;
+    }
+    return found;
+}
+
 /** Read the configuration, if not existent ask the user to select points.
  * @param img_in input image
  * @param config_folder configuration folder path
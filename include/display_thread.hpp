@@ -0,0 +1,202 @@
+/** \file display_thread.hpp
+ * @brief Non-blocking image display.
+ *
+ * cv::imshow + cv::waitKey on the camera callback adds up to the waitKey
+ * delay to every frame. Here a dedicated thread owns the window: the caller
+ * only copies the frame into a latest-frame mailbox (older frames not shown
+ * yet are replaced), and key presses are handed back asynchronously as save
+ * requests carrying the frame that was on screen.
+ * HighGUI must not be used by two threads at the same time: code that opens
+ * its own windows (modal panels, debug views) holds a GuiLock, which pauses
+ * every display thread (their windows are closed) until it is released.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "opencv2/highgui.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//! Display utilities
+namespace Display {
+
+/** Frame shown by the display or requested to be saved. */
+struct Frame {
+    std::string topic;  ///< Frame topic.
+    cv::Mat image;      ///< Frame image.
+};
+
+class DisplayThread;
+
+/** Display threads of the process and GuiLock state. */
+struct Registry {
+    std::recursive_mutex gui;               ///< Held by the thread using HighGUI outside the display threads.
+    std::mutex mutex;                       ///< Protects displays and locks.
+    std::vector<DisplayThread*> displays;   ///< Existing display threads.
+    unsigned int locks = 0;                 ///< Live GuiLock instances.
+};
+
+/** @return the registry of the process */
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+/** Window driven by its own thread. */
+class DisplayThread {
+public:
+    /** Starts the display thread (paused while a GuiLock is held).
+     * @param window window name
+     * @param saveKey key that requests a snapshot of the frame on screen
+     * @param pollMs key polling period (ms)
+    */
+    DisplayThread(const std::string& window, char saveKey = 's', int pollMs = 30)
+        : window(window), saveKey(saveKey), pollMs(pollMs), running(false) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.displays.push_back(this);
+        if (r.locks == 0)
+            resume();
+    }
+
+    ~DisplayThread() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.displays.erase(std::find(r.displays.begin(), r.displays.end(), this));
+        pause();
+    }
+
+    DisplayThread(const DisplayThread&) = delete;
+    DisplayThread& operator=(const DisplayThread&) = delete;
+
+    /** Posts a frame to be shown (never waits for the GUI).
+     * The frame is copied into a recycled buffer, so the caller can reuse
+     * its image right after the call.
+     * @param topic frame topic
+     * @param img frame image
+    */
+    void show(const std::string& topic, const cv::Mat& img) {
+        img.copyTo(back.image);
+        back.topic = topic;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::swap(back, pending);
+            fresh = true;
+        }
+        cond.notify_one();
+    }
+
+    /** Takes the oldest save request.
+     * @param frame output frame that was on screen when the key was pressed
+     * @return false if there are no requests
+    */
+    bool takeSaveRequest(Frame& frame) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (requests.empty())
+            return false;
+        frame = requests.front();
+        requests.pop_front();
+        return true;
+    }
+
+private:
+    friend class GuiLock;
+
+    /** Stops the thread and closes the window. Frames keep being posted. */
+    void pause() {
+        running = false;
+        cond.notify_all();
+        if (thread.joinable())
+            thread.join();
+    }
+
+    /** Starts the thread again. */
+    void resume() {
+        running = true;
+        thread = std::thread(&DisplayThread::loop, this);
+    }
+
+    /** Body of the display thread. */
+    void loop() {
+        cv::namedWindow(window);
+        if (!shown.image.empty())
+            cv::imshow(window, shown.image);    // window reopened after a pause
+        while (running) {
+            bool updated = false;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait_for(lock, std::chrono::milliseconds(pollMs),
+                              [this] { return fresh || !running; });
+                if (fresh) {
+                    std::swap(pending, shown);
+                    fresh = false;
+                    updated = true;
+                }
+            }
+            if (updated)
+                cv::imshow(window, shown.image);
+            const char c = cv::waitKey(1);
+            if ((c == saveKey) && !shown.image.empty()) {
+                Frame request;
+                request.topic = shown.topic;
+                request.image = shown.image.clone();
+                std::lock_guard<std::mutex> lock(mutex);
+                requests.push_back(request);
+            }
+        }
+        cv::destroyWindow(window);
+    }
+
+    const std::string window;           ///< Window name.
+    const char saveKey;                 ///< Snapshot key.
+    const int pollMs;                   ///< Key polling period (ms).
+    std::atomic<bool> running;          ///< False when stopping.
+
+    std::mutex mutex;                   ///< Protects pending, fresh and requests.
+    std::condition_variable cond;       ///< Signals new frames.
+    Frame back;                         ///< Buffer filled by show (caller thread only).
+    Frame pending;                      ///< Newest frame not shown yet.
+    bool fresh = false;                 ///< True if pending holds a new frame.
+    Frame shown;                        ///< Frame on screen (display thread only).
+    std::deque<Frame> requests;         ///< Save requests, oldest first.
+    std::thread thread;                 ///< Display thread.
+};
+
+/** Exclusive HighGUI access for the calling thread.
+ * While an instance lives the display threads are paused and other threads
+ * taking a GuiLock wait. Instances can be nested.
+*/
+class GuiLock {
+public:
+    GuiLock() : gui(registry().gui) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (r.locks++ == 0)
+            for (DisplayThread* d : r.displays)
+                d->pause();
+    }
+
+    ~GuiLock() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (--r.locks == 0)
+            for (DisplayThread* d : r.displays)
+                d->resume();
+    }
+
+    GuiLock(const GuiLock&) = delete;
+    GuiLock& operator=(const GuiLock&) = delete;
+
+private:
+    std::lock_guard<std::recursive_mutex> gui;  ///< HighGUI ownership of the thread.
+};
+
+}   // namespace Display
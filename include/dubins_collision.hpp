@@ -0,0 +1,97 @@
+/** \file dubins_collision.hpp
+ * @brief Collision checks of Dubins curves shared by the kinodynamic planners.
+ *
+ * A curve is checked on its discretization: consecutive points are joined by
+ * segments tested with the CollisionChecker. Contacts at a query point (a
+ * start or a goal on the safe borders) are ignored as for the point planners.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "collision_checker.hpp"
+#include "dubins.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+//! Point path planning
+namespace Planning {
+
+/** Checks a curve for collisions on its discretization.
+ * @param checker collision checker of the arena
+ * @param curve curve to check
+ * @param resolution discretization step (m)
+ * @param fromQuery true if the curve starts at a query point (contacts there are ignored)
+ * @param toQuery true if the curve ends at a query point (contacts there are ignored)
+ * @return true if the curve is free
+*/
+bool curveFree(const CollisionChecker& checker, dubins::Curve curve, double resolution, bool fromQuery, bool toQuery) {
+    std::vector<Point> points;
+    for (const dubins::Position& p : curve.discretizeSingleCurve(resolution))
+        points.emplace_back(p.x, p.y);
+    const Point end(curve.a3.xf, curve.a3.yf);
+    if (points.empty() || (distance(points.back(), end) > 0))
+        points.emplace_back(end);
+    for (size_t i = 1; i < points.size(); ++i) {
+        bool free;
+        if (fromQuery && (i == 1))
+            free = checker.segmentFreeFrom(points[0], points[1]);
+        else if (toQuery && (i == points.size() - 1))
+            free = checker.segmentFreeFrom(points[i], points[i-1]);
+        else
+            free = checker.segmentFree(points[i-1], points[i]);
+        if (!free)
+            return false;
+    }
+    return true;
+}
+
+/** Finds the shortest free Dubins curve from a pose to a goal point.
+ * With a free arrival heading, the heading of the straight line and
+ * headings evenly spaced on the circle are tried.
+ * @param checker collision checker of the arena
+ * @param x starting point x coordinate
+ * @param y starting point y coordinate
+ * @param th starting angle
+ * @param goal goal point (a query point)
+ * @param thf goal heading (ignored with freeHeading)
+ * @param freeHeading true if any arrival heading is fine
+ * @param headings headings tried with freeHeading
+ * @param kMax maximum curvature
+ * @param resolution discretization step of the collision checks (m)
+ * @param fromQuery true if the pose is a query point
+ * @param arrival output shortest free curve
+ * @return true if a free curve was found
+*/
+bool freeCurveTo(const CollisionChecker& checker, double x, double y, double th,
+                 const Point& goal, double thf, bool freeHeading, unsigned int headings,
+                 double kMax, double resolution, bool fromQuery, dubins::Curve& arrival) {
+    std::vector<double> arrivals = {thf};
+    if (freeHeading) {
+        arrivals = {std::atan2(goal.y - y, goal.x - x)};
+        for (unsigned int h = 0; h < headings; ++h)
+            arrivals.push_back(2 * M_PI * h / headings);
+    }
+
+    std::vector<std::pair<double, dubins::Curve>> candidates;
+    for (double a : arrivals) {
+        int pidx;
+        dubins::Curve c = dubins::dubins_shortest_path(x, y, th, goal.x, goal.y, a, kMax, pidx);
+        if (pidx >= 0)
+            candidates.emplace_back(c.L, c);
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const std::pair<double, dubins::Curve>& l, const std::pair<double, dubins::Curve>& r) {
+                  return l.first < r.first;
+              });
+    for (const std::pair<double, dubins::Curve>& c : candidates)
+        if (curveFree(checker, c.second, resolution, fromQuery, true)) {
+            arrival = c.second;
+            return true;
+        }
+    return false;
+}
+
+}   // namespace Planning
@@ -0,0 +1,266 @@
+/** \file dubins_rrt.hpp
+ * @brief Kinodynamic RRT with Dubins steering.
+ *
+ * The tree nodes are poses (x, y, theta) and every edge is a shortest Dubins
+ * curve with the robot maximum curvature, cut at the step length, so the
+ * result can be followed as it is: no smoothing nor multipoint Dubins stage
+ * is needed. Edges are checked for collisions on their discretization.
+ *
+ * The nearest node of a sample is the one with the shortest Dubins curve
+ * among its nearest neighbours in the plane. Nodes close to the goal try to
+ * reach it directly (with a free arrival heading, several headings are
+ * tried). The curves of the solution are then shortcut: every pose is
+ * joined to the farthest later pose reachable with a free Dubins curve.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "collision_checker.hpp"
+#include "dubins.hpp"
+#include "dubins_collision.hpp"
+#include "spatial_grid.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+//! Point path planning
+namespace Planning {
+
+/** Kinodynamic RRT planner of Dubins paths. */
+class DubinsRRT {
+public:
+    /** Planner parameters. */
+    struct Parameters {
+        double kMax = 10;               ///< Maximum curvature.
+        double step = 0.3;              ///< Maximum edge length (m).
+        double goalRadius = 0.5;        ///< Nodes closer than this try to reach the goal (m).
+        double goalBias = 0.1;          ///< Probability of sampling the goal.
+        unsigned int goalHeadings = 8;  ///< Headings tried at a goal with free heading.
+        size_t neighbours = 5;          ///< Nearest nodes compared with the Dubins length.
+        size_t maxIterations = 5000;    ///< Iteration limit of a query.
+        double resolution = 0.01;       ///< Curve discretization for collision checks (m).
+        uint32_t seed = 1;              ///< Random seed.
+    };
+
+    /** Creates the planner.
+     * @param checker collision checker of the arena
+     * @param parameters planner parameters
+    */
+    DubinsRRT(const CollisionChecker& checker, const Parameters& parameters)
+        : checker(checker), parameters(parameters), rng(parameters.seed) {}
+
+    /** Plans a Dubins path between two poses.
+     * Throws std::runtime_error("Path not found!") if there is no path.
+     * @param x0 starting point x coordinate
+     * @param y0 starting point y coordinate
+     * @param th0 starting angle
+     * @param xf arrival point x coordinate
+     * @param yf arrival point y coordinate
+     * @param thf arrival angle (ignored with freeHeading)
+     * @param freeHeading true if any arrival angle is fine
+     * @return the Dubins curves, from start to goal
+    */
+    std::vector<dubins::Curve> plan(double x0, double y0, double th0,
+                                    double xf, double yf, double thf, bool freeHeading) {
+        iterations = 0;
+        const Point goal(xf, yf);
+        Tree tree(checker);
+        tree.add(x0, y0, th0, -1, dubins::Curve());
+
+        std::uniform_real_distribution<double> unit(0, 1);
+        std::uniform_real_distribution<double> x(checker.minXBound(), checker.maxXBound());
+        std::uniform_real_distribution<double> y(checker.minYBound(), checker.maxYBound());
+
+        int last = -1;          // node reaching the goal
+        dubins::Curve arrival;  // curve from last to the goal
+        if (reachGoal(tree, 0, goal, thf, freeHeading, arrival))
+            last = 0;
+
+        for (; (last == -1) && (iterations < parameters.maxIterations); ++iterations) {
+            double sx, sy, sth = 2 * M_PI * unit(rng);
+            if (unit(rng) < parameters.goalBias) {
+                sx = xf;
+                sy = yf;
+                if (!freeHeading)
+                    sth = thf;
+            } else {
+                sx = x(rng);
+                sy = y(rng);
+            }
+
+            // nearest node in Dubins length among the nearest in the plane
+            int from = -1;
+            dubins::Curve curve;
+            for (int n : tree.grid.kNearest(Point(sx, sy), parameters.neighbours)) {
+                int pidx;
+                const Point& p = tree.grid.point(n);
+                dubins::Curve c = dubins::dubins_shortest_path(p.x, p.y, tree.theta[n], sx, sy, sth,
+                                                               parameters.kMax, pidx);
+                if ((pidx >= 0) && ((from == -1) || (c.L < curve.L))) {
+                    from = n;
+                    curve = c;
+                }
+            }
+            if (from == -1)
+                continue;
+
+            curve = truncate(curve, parameters.step);
+            if (!curveFree(checker, curve, parameters.resolution, from == 0, false))
+                continue;
+            const int id = tree.add(curve.a3.xf, curve.a3.yf, curve.a3.thf, from, curve);
+
+            if ((distance(tree.grid.point(id), goal) <= parameters.goalRadius) &&
+                reachGoal(tree, id, goal, thf, freeHeading, arrival))
+                last = id;
+        }
+        if (last == -1)
+            throw std::runtime_error("Path not found!");
+
+        // poses and curves from the start to the goal
+        std::vector<int> chain;
+        for (int n = last; n != -1; n = tree.parent[n])
+            chain.push_back(n);
+        std::reverse(chain.begin(), chain.end());
+        std::vector<State> poses;
+        std::vector<dubins::Curve> curves;
+        for (int n : chain) {
+            poses.push_back({tree.grid.point(n), tree.theta[n]});
+            if (n != 0)
+                curves.push_back(tree.curve[n]);
+        }
+        poses.push_back({goal, arrival.a3.thf});
+        curves.push_back(arrival);
+        return shortcut(poses, curves);
+    }
+
+    /** Plans a Dubins path through a list of points.
+     * Any heading is fine at the intermediate points.
+     * Throws std::runtime_error("Path not found!") if a leg has no path.
+     * @param x0 starting point x coordinate
+     * @param y0 starting point y coordinate
+     * @param th0 starting angle
+     * @param waypoints points to go through, in order
+     * @param xf arrival point x coordinate
+     * @param yf arrival point y coordinate
+     * @param thf arrival angle
+     * @return the Dubins curves, from start to goal
+    */
+    std::vector<dubins::Curve> planThrough(double x0, double y0, double th0, const std::vector<Point>& waypoints,
+                                           double xf, double yf, double thf) {
+        std::vector<dubins::Curve> path;
+        size_t total = 0;
+        for (size_t i = 0; i <= waypoints.size(); ++i) {
+            const bool isLast = (i == waypoints.size());
+            const Point target = isLast ? Point(xf, yf) : waypoints[i];
+            const std::vector<dubins::Curve> leg = plan(x0, y0, th0, target.x, target.y, thf, !isLast);
+            total += iterations;
+            path.insert(path.end(), leg.begin(), leg.end());
+            x0 = leg.back().a3.xf;
+            y0 = leg.back().a3.yf;
+            th0 = leg.back().a3.thf;
+        }
+        iterations = total;
+        return path;
+    }
+
+    size_t lastIterations() const { return iterations; }    ///< Iterations of the last query.
+
+private:
+    /** State of a path. */
+    struct State {
+        Point p;        ///< Position.
+        double theta;   ///< Heading.
+    };
+
+    /** Search tree of poses. */
+    struct Tree {
+        PointGrid grid;                     ///< Node positions and their index.
+        std::vector<double> theta;          ///< Heading of every node.
+        std::vector<int> parent;            ///< Parent of every node (-1 for the root).
+        std::vector<dubins::Curve> curve;   ///< Curve from the parent.
+
+        explicit Tree(const CollisionChecker& checker)
+            : grid(checker.minXBound(), checker.minYBound(), checker.maxXBound(), checker.maxYBound(), GRID_CELL) {}
+
+        /** Adds a node.
+         * @return the node index
+        */
+        int add(double x, double y, double th, int from, const dubins::Curve& c) {
+            theta.push_back(th);
+            parent.push_back(from);
+            curve.push_back(c);
+            return grid.insert(Point(x, y));
+        }
+    };
+
+    /** Cuts a curve at a length.
+     * @param c curve
+     * @param length maximum length
+     * @return the first part of c
+    */
+    static dubins::Curve truncate(const dubins::Curve& c, double length) {
+        if (c.L <= length)
+            return c;
+        const double s1 = std::min(c.a1.L, length);
+        const double s2 = std::min(c.a2.L, length - s1);
+        const double s3 = std::min(c.a3.L, length - s1 - s2);
+        return dubins::Curve(c.a1.x0, c.a1.y0, c.a1.th0, s1, s2, s3, c.a1.k, c.a2.k, c.a3.k);
+    }
+
+    /** Tries to join a node to the goal.
+     * @param tree tree
+     * @param n node
+     * @param goal goal point
+     * @param thf goal heading (ignored with freeHeading)
+     * @param freeHeading true if any arrival heading is fine
+     * @param arrival output shortest free curve to the goal
+     * @return true if a free curve was found
+    */
+    bool reachGoal(const Tree& tree, int n, const Point& goal, double thf, bool freeHeading,
+                   dubins::Curve& arrival) const {
+        const Point& p = tree.grid.point(n);
+        return freeCurveTo(checker, p.x, p.y, tree.theta[n], goal, thf, freeHeading, parameters.goalHeadings,
+                           parameters.kMax, parameters.resolution, n == 0, arrival);
+    }
+
+    /** Joins every pose to the farthest later pose reachable with a free curve.
+     * @param poses poses of the path (start and goal included)
+     * @param curves curves between consecutive poses
+     * @return the shortcut curves
+    */
+    std::vector<dubins::Curve> shortcut(const std::vector<State>& poses, const std::vector<dubins::Curve>& curves) const {
+        std::vector<dubins::Curve> result;
+        const size_t last = poses.size() - 1;
+        for (size_t i = 0; i < last; ) {
+            size_t j = last;
+            for (; j > i + 1; --j) {
+                int pidx;
+                dubins::Curve c = dubins::dubins_shortest_path(poses[i].p.x, poses[i].p.y, poses[i].theta,
+                                                               poses[j].p.x, poses[j].p.y, poses[j].theta,
+                                                               parameters.kMax, pidx);
+                if ((pidx >= 0) && curveFree(checker, c, parameters.resolution, i == 0, j == last)) {
+                    result.push_back(c);
+                    break;
+                }
+            }
+            if (j == i + 1)
+                result.push_back(curves[i]);
+            i = j;
+        }
+        return result;
+    }
+
+    static constexpr float GRID_CELL = 0.05f;   ///< Neighbour index cell (m).
+
+    const CollisionChecker checker;     ///< Arena collision checker.
+    const Parameters parameters;        ///< Planner parameters.
+    std::mt19937 rng;                   ///< Sampling generator (kept across queries).
+    size_t iterations = 0;              ///< Iterations of the last query.
+};
+
+}   // namespace Planning
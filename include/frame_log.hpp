@@ -0,0 +1,353 @@
+/** \file frame_log.hpp
+ * @brief Binary append-only frame log: recorder and memory-mapped reader.
+ *
+ * A log is a single file made of a file header followed by frame records:
+ *
+ *     file:   "ARFLOG01"
+ *     record: RecordHeader | topic | padding | payload
+ *
+ * Payloads start at 16 byte aligned file offsets. Raw payloads hold the
+ * pixel rows back to back, so the reader can wrap them in a cv::Mat without
+ * copying (copy-on-write mapping); PNG payloads are lossless and decoded on
+ * access.
+ * The recorder appends from a writer thread, so the caller only pays for a
+ * frame copy; a failed write stops the recorder and is thrown by the next
+ * record call. A truncated last record (e.g. after a crash) is ignored by the
+ * reader, a record whose header does not match its payload is rejected.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "opencv2/imgcodecs.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//! Frame log utilities
+namespace FrameLog {
+
+const char FILE_MAGIC[8] = {'A','R','F','L','O','G','0','1'}; ///< File header.
+const uint32_t RECORD_MAGIC = 0x454d5246;   ///< "FRME" (little endian).
+const size_t PAYLOAD_ALIGNMENT = 16;        ///< Payload alignment in the file.
+
+/** Payload encoding. */
+enum class Encoding : uint32_t {
+    raw = 0,    ///< Pixel rows back to back (zero-copy replay).
+    png = 1     ///< Lossless PNG.
+};
+
+/** Header of a frame record. */
+struct RecordHeader {
+    uint32_t magic;         ///< RECORD_MAGIC.
+    uint32_t encoding;      ///< Payload encoding (Encoding).
+    int64_t timestamp;      ///< Capture time (ns, steady clock).
+    int32_t rows;           ///< Image rows.
+    int32_t cols;           ///< Image columns.
+    int32_t type;           ///< OpenCV image type.
+    uint32_t topicSize;     ///< Topic length (bytes).
+    uint64_t payloadOffset; ///< Payload offset from the record start.
+    uint64_t payloadSize;   ///< Payload size (bytes).
+};
+
+/** Appends frames to a log from a writer thread. */
+class Recorder {
+public:
+    /** Opens (or creates) the log and starts the writer thread.
+     * @param path log file path
+     * @param encoding payload encoding
+    */
+    Recorder(const std::string& path, Encoding encoding = Encoding::raw)
+        : encoding(encoding) {
+        file = std::fopen(path.c_str(), "ab");
+        if (file == nullptr)
+            throw std::runtime_error("Cannot write file: " + path);
+        std::fseek(file, 0, SEEK_END);
+        if ((std::ftell(file) == 0) &&
+            ((std::fwrite(FILE_MAGIC, 1, sizeof(FILE_MAGIC), file) != sizeof(FILE_MAGIC)) ||
+             (std::fflush(file) != 0))) {
+            std::fclose(file);
+            throw std::runtime_error("Cannot write file: " + path);
+        }
+        offset = std::ftell(file);
+        writer = std::thread(&Recorder::writeLoop, this);
+    }
+
+    /** Writes the queued frames and closes the log. */
+    ~Recorder() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        cond.notify_all();
+        if (writer.joinable())
+            writer.join();
+        std::fclose(file);
+    }
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    /** Queues a frame (never blocks on disk).
+     * @param topic frame topic
+     * @param img frame (copied)
+     * @throws std::runtime_error if a previous frame could not be written
+    */
+    void record(const std::string& topic, const cv::Mat& img) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error.empty())
+                throw std::runtime_error(error);
+        }
+        Pending p;
+        p.topic = topic;
+        p.image = img.clone();
+        p.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch()).count();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(p);
+        }
+        cond.notify_one();
+    }
+
+    /** @return number of frames waiting to be written */
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.size();
+    }
+
+private:
+    /** Frame waiting to be written. */
+    struct Pending {
+        std::string topic;  ///< Frame topic.
+        cv::Mat image;      ///< Frame copy.
+        int64_t timestamp;  ///< Capture time (ns).
+    };
+
+    /** Body of the writer thread: stops at the first failed write. */
+    void writeLoop() {
+        std::vector<uchar> encoded;
+        while (true) {
+            Pending p;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock, [this] { return !queue.empty() || !running; });
+                if (queue.empty())
+                    return;     // stopping, everything written
+                p = queue.front();
+                queue.pop_front();
+            }
+            try {
+                write(p, encoded);
+            } catch (const std::exception& e) {
+                std::lock_guard<std::mutex> lock(mutex);
+                error = e.what();
+                queue.clear();
+                return;
+            }
+        }
+    }
+
+    /** Appends one record.
+     * @param p frame to write
+     * @param encoded encoding buffer
+     * @throws std::runtime_error if the record is not completely written
+    */
+    void write(const Pending& p, std::vector<uchar>& encoded) {
+        RecordHeader h;
+        h.magic = RECORD_MAGIC;
+        h.encoding = static_cast<uint32_t>(encoding);
+        h.timestamp = p.timestamp;
+        h.rows = p.image.rows;
+        h.cols = p.image.cols;
+        h.type = p.image.type();
+        h.topicSize = p.topic.size();
+        const uint64_t unaligned = offset + sizeof(RecordHeader) + h.topicSize;
+        const uint64_t aligned = (unaligned + PAYLOAD_ALIGNMENT - 1) / PAYLOAD_ALIGNMENT * PAYLOAD_ALIGNMENT;
+        h.payloadOffset = aligned - offset;
+
+        if (encoding == Encoding::png) {
+            cv::imencode(".png", p.image, encoded);
+            h.payloadSize = encoded.size();
+        } else {
+            h.payloadSize = p.image.total() * p.image.elemSize();
+        }
+
+        const char zeros[PAYLOAD_ALIGNMENT] = {0};
+        bool written = (std::fwrite(&h, sizeof(h), 1, file) == 1) &&
+                       (std::fwrite(p.topic.data(), 1, p.topic.size(), file) == p.topic.size()) &&
+                       (std::fwrite(zeros, 1, aligned - unaligned, file) == aligned - unaligned);
+        if (encoding == Encoding::png) {
+            written = written && (std::fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size());
+        } else {
+            const size_t rowSize = p.image.cols * p.image.elemSize();
+            for (int y = 0; written && (y < p.image.rows); ++y)
+                written = (std::fwrite(p.image.ptr(y), 1, rowSize, file) == rowSize);
+        }
+        if (!written || (std::fflush(file) != 0))
+            throw std::runtime_error("FrameLog: cannot write frame '" + p.topic + "'");
+        offset = aligned + h.payloadSize;
+    }
+
+    const Encoding encoding;            ///< Payload encoding.
+    std::FILE* file;                    ///< Log file.
+    uint64_t offset;                    ///< Current end of the log.
+    mutable std::mutex mutex;           ///< Protects the queue and the error.
+    std::condition_variable cond;       ///< Signals queued frames.
+    std::deque<Pending> queue;          ///< Frames waiting to be written.
+    bool running = true;                ///< False when stopping.
+    std::string error;                  ///< First write error (empty if none).
+    std::thread writer;                 ///< Writer thread.
+};
+
+/** Frame read from a log. */
+struct Frame {
+    int64_t timestamp;  ///< Capture time (ns).
+    std::string topic;  ///< Frame topic.
+    cv::Mat image;      ///< Image (raw frames point into the mapped log).
+};
+
+/** Random-access reader of a memory-mapped log. */
+class Reader {
+public:
+    /** Maps the log and indexes its records.
+     * @param path log file path
+    */
+    explicit Reader(const std::string& path) {
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Cannot read file: " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot read file: " + path);
+        }
+        size = st.st_size;
+        if (size < sizeof(FILE_MAGIC)) {
+            ::close(fd);
+            throw std::runtime_error("Malformed file: " + path);
+        }
+        // private writable mapping: pages are shared with the page cache and
+        // copied only if a caller draws on a replayed image
+        void* m = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (m == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map file: " + path);
+        }
+        data = static_cast<const uchar*>(m);
+        if (std::memcmp(data, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+            release();
+            throw std::runtime_error("Malformed file: " + path);
+        }
+
+        // index the complete records
+        uint64_t off = sizeof(FILE_MAGIC);
+        while (off + sizeof(RecordHeader) <= size) {
+            RecordHeader h;
+            std::memcpy(&h, data + off, sizeof(h));
+            if ((h.magic != RECORD_MAGIC) || (h.payloadOffset > size - off) ||
+                (h.payloadSize > size - off - h.payloadOffset))
+                break;
+            if (!consistent(h)) {
+                release();
+                throw std::runtime_error("Malformed frame record in file: " + path);
+            }
+            records.push_back(off);
+            off += h.payloadOffset + h.payloadSize;
+        }
+    }
+
+    ~Reader() { release(); }
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    /** @return number of frames in the log */
+    size_t count() const { return records.size(); }
+
+    /** Reads the topic of a frame, without decoding its image.
+     * @param i frame index
+     * @return the frame topic
+    */
+    std::string topic(size_t i) const {
+        if (i >= records.size())
+            throw std::out_of_range("FrameLog: frame index out of range");
+        const uchar* rec = data + records[i];
+        RecordHeader h;
+        std::memcpy(&h, rec, sizeof(h));
+        return std::string(reinterpret_cast<const char*>(rec + sizeof(h)), h.topicSize);
+    }
+
+    /** Reads a frame.
+     * @param i frame index
+     * @return the frame; raw images share the mapped memory (valid while the reader lives)
+    */
+    Frame at(size_t i) const {
+        if (i >= records.size())
+            throw std::out_of_range("FrameLog: frame index out of range");
+        const uchar* rec = data + records[i];
+        RecordHeader h;
+        std::memcpy(&h, rec, sizeof(h));
+
+        Frame f;
+        f.timestamp = h.timestamp;
+        f.topic.assign(reinterpret_cast<const char*>(rec + sizeof(h)), h.topicSize);
+        const uchar* payload = rec + h.payloadOffset;
+        if (h.encoding == static_cast<uint32_t>(Encoding::png)) {
+            f.image = cv::imdecode(cv::Mat(1, h.payloadSize, CV_8UC1, const_cast<uchar*>(payload)),
+                                   cv::IMREAD_UNCHANGED);
+            if ((f.image.rows != h.rows) || (f.image.cols != h.cols) || (f.image.type() != h.type))
+                throw std::runtime_error("FrameLog: malformed PNG payload of frame " + std::to_string(i));
+        } else {
+            f.image = cv::Mat(h.rows, h.cols, h.type, const_cast<uchar*>(payload));
+        }
+        return f;
+    }
+
+private:
+    /** Checks a record header against its own sizes.
+     * Raw payloads must hold exactly rows * cols pixels of the image type.
+     * @param h record header
+     * @return true if the record can be read
+    */
+    static bool consistent(const RecordHeader& h) {
+        if ((h.payloadOffset < sizeof(RecordHeader) + uint64_t(h.topicSize)) ||
+            (h.rows < 0) || (h.cols < 0) || ((h.type & ~CV_MAT_TYPE_MASK) != 0))
+            return false;
+        if (h.encoding == static_cast<uint32_t>(Encoding::png))
+            return true;
+        return (h.encoding == static_cast<uint32_t>(Encoding::raw)) &&
+               (h.payloadSize == uint64_t(h.rows) * uint64_t(h.cols) * CV_ELEM_SIZE(h.type));
+    }
+
+    /** Unmaps and closes the log. */
+    void release() {
+        if (data != nullptr)
+            ::munmap(const_cast<uchar*>(data), size);
+        if (fd >= 0)
+            ::close(fd);
+        data = nullptr;
+        fd = -1;
+    }
+
+    int fd = -1;                        ///< Log file descriptor.
+    const uchar* data = nullptr;        ///< Mapped log.
+    uint64_t size = 0;                  ///< Log size.
+    std::vector<uint64_t> records;      ///< Offset of every record.
+};
+
+}   // namespace FrameLog
@@ -0,0 +1,134 @@
+/** \file frame_replay.hpp
+ * @brief Prefetching image sequence replayer.
+ *
+ * Frames of an image list are decoded ahead of time by a background thread
+ * into a bounded ring of cv::Mat buffers, so the caller never waits for a
+ * JPEG decode: every call returns a frame that is already in memory.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "opencv2/imgcodecs.hpp"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+//! Image sequence replay utilities
+namespace FrameReplay {
+
+/** Behaviour at the end of the image list. */
+enum class EndPolicy {
+    loop,   ///< Start again from the first image.
+    stop    ///< Keep returning the last image, next() returns false.
+};
+
+/** Replays an image list, decoding it ahead on a background thread. */
+class FrameReplayer {
+public:
+    /** Starts the decoder thread.
+     * @param files images to replay, in order
+     * @param hold number of calls every image is returned for (>= 1)
+     * @param policy behaviour at the end of the list
+     * @param capacity number of decoded images buffered ahead
+    */
+    FrameReplayer(const std::vector<std::string>& files, size_t hold,
+                  EndPolicy policy, size_t capacity = 4)
+        : files(files), hold(hold), policy(policy), capacity(capacity) {
+        if (files.empty())
+            throw std::invalid_argument("FrameReplayer: empty image list");
+        if ((hold == 0) || (capacity == 0))
+            throw std::invalid_argument("FrameReplayer: hold and capacity must be positive");
+        decoder = std::thread(&FrameReplayer::decodeLoop, this);
+    }
+
+    ~FrameReplayer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        spaceCond.notify_all();
+        if (decoder.joinable())
+            decoder.join();
+    }
+
+    FrameReplayer(const FrameReplayer&) = delete;
+    FrameReplayer& operator=(const FrameReplayer&) = delete;
+
+    /** Returns the current frame, advancing every hold calls.
+     * Waits only if the decoder is behind (e.g. at the very first call).
+     * An image that cannot be decoded is returned empty, as cv::imread does.
+     * @param frame output frame (shared buffer, do not modify)
+     * @return false once the end of the list is reached with EndPolicy::stop
+    */
+    bool next(cv::Mat& frame) {
+        if ((served == 0) || ((served >= hold) && !finished)) {
+            std::unique_lock<std::mutex> lock(mutex);
+            frameCond.wait(lock, [this] { return !ring.empty() || decoderDone; });
+            if (!ring.empty()) {
+                current = ring.front();
+                ring.pop_front();
+                served = 0;
+                spaceCond.notify_one();
+            } else {
+                finished = true;    // decoder done, ring drained
+            }
+        }
+        ++served;
+        frame = current;
+        return !finished;
+    }
+
+private:
+    /** Body of the decoder thread. */
+    void decodeLoop() {
+        size_t idx = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                spaceCond.wait(lock, [this] { return (ring.size() < capacity) || !running; });
+                if (!running)
+                    return;
+            }
+            cv::Mat img = cv::imread(files[idx]);   // decoded outside the lock, empty on failure
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ring.push_back(img);
+            }
+            frameCond.notify_one();
+
+            if (++idx == files.size()) {
+                if (policy == EndPolicy::stop) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    decoderDone = true;
+                    frameCond.notify_one();
+                    return;
+                }
+                idx = 0;
+            }
+        }
+    }
+
+    const std::vector<std::string> files;   ///< Images to replay.
+    const size_t hold;                      ///< Calls every image is returned for.
+    const EndPolicy policy;                 ///< End of list behaviour.
+    const size_t capacity;                  ///< Decoded images buffered ahead.
+
+    std::mutex mutex;                       ///< Protects ring and decoder state.
+    std::condition_variable frameCond;      ///< Signals decoded frames.
+    std::condition_variable spaceCond;      ///< Signals free ring slots.
+    std::deque<cv::Mat> ring;               ///< Decoded images, oldest first.
+    bool running = true;                    ///< False when stopping.
+    bool decoderDone = false;               ///< No more images will be decoded.
+    std::thread decoder;                    ///< Decoder thread.
+
+    cv::Mat current;                        ///< Image being served (consumer only).
+    size_t served = 0;                      ///< Calls served with current (consumer only).
+    bool finished = false;                  ///< End reached (consumer only).
+};
+
+}   // namespace FrameReplay
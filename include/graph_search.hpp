@@ -0,0 +1,138 @@
+/** \file graph_search.hpp
+ * @brief Weighted graph and shortest path searches (A*, Dijkstra).
+ *
+ * Used by the roadmap based point planners: the roadmap is built once per
+ * map, every query only runs a search on it.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+//! Point path planning
+namespace Planning {
+
+/** Undirected weighted graph (adjacency lists). */
+struct Graph {
+    std::vector<std::vector<std::pair<int, double>>> adjacency; ///< (neighbour, weight) of every node.
+
+    /** Adds a node.
+     * @return the index of the new node
+    */
+    int addNode() {
+        adjacency.emplace_back();
+        return static_cast<int>(adjacency.size()) - 1;
+    }
+
+    /** Adds an undirected edge.
+     * @param a first node
+     * @param b second node
+     * @param weight edge weight
+    */
+    void addEdge(int a, int b, double weight) {
+        adjacency[a].emplace_back(b, weight);
+        adjacency[b].emplace_back(a, weight);
+    }
+
+    /** @return number of nodes */
+    size_t size() const { return adjacency.size(); }
+
+    /** @return number of undirected edges */
+    size_t edgeCount() const {
+        size_t n = 0;
+        for (const auto& neighbours : adjacency)
+            n += neighbours.size();
+        return n / 2;
+    }
+};
+
+/** Rebuilds a node path from a parent table.
+ * @param parent parent of every node (-1 for the root)
+ * @param goal last node
+ * @return nodes from the root to goal
+*/
+std::vector<int> tracePath(const std::vector<int>& parent, int goal) {
+    std::vector<int> path;
+    for (int n = goal; n != -1; n = parent[n])
+        path.push_back(n);
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+/** A* shortest path search.
+ * @param graph graph
+ * @param start start node
+ * @param goal goal node
+ * @param heuristic admissible estimate of the cost from a node to goal
+ * @param path output nodes from start to goal
+ * @return false if goal cannot be reached
+*/
+bool aStar(const Graph& graph, int start, int goal,
+           const std::function<double(int)>& heuristic, std::vector<int>& path) {
+    typedef std::pair<double, int> Entry;   // (estimated total cost, node)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    std::vector<double> cost(graph.size(), std::numeric_limits<double>::infinity());
+    std::vector<int> parent(graph.size(), -1);
+    std::vector<bool> closed(graph.size(), false);
+
+    cost[start] = 0;
+    open.emplace(heuristic(start), start);
+    while (!open.empty()) {
+        const int n = open.top().second;
+        open.pop();
+        if (closed[n])
+            continue;   // stale entry
+        if (n == goal) {
+            path = tracePath(parent, goal);
+            return true;
+        }
+        closed[n] = true;
+        for (const auto& edge : graph.adjacency[n]) {
+            const double c = cost[n] + edge.second;
+            if (c < cost[edge.first]) {
+                cost[edge.first] = c;
+                parent[edge.first] = n;
+                open.emplace(c + heuristic(edge.first), edge.first);
+            }
+        }
+    }
+    return false;
+}
+
+/** Dijkstra one-to-all shortest paths.
+ * @param graph graph
+ * @param source source node
+ * @param cost output cost of every node (infinity if unreachable)
+ * @param parent output parent of every node on its shortest path (-1 for source and unreachable nodes)
+*/
+void dijkstra(const Graph& graph, int source, std::vector<double>& cost, std::vector<int>& parent) {
+    typedef std::pair<double, int> Entry;   // (cost, node)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    cost.assign(graph.size(), std::numeric_limits<double>::infinity());
+    parent.assign(graph.size(), -1);
+
+    cost[source] = 0;
+    open.emplace(0, source);
+    while (!open.empty()) {
+        const Entry top = open.top();
+        open.pop();
+        if (top.first > cost[top.second])
+            continue;   // stale entry
+        for (const auto& edge : graph.adjacency[top.second]) {
+            const double c = top.first + edge.second;
+            if (c < cost[edge.first]) {
+                cost[edge.first] = c;
+                parent[edge.first] = top.second;
+                open.emplace(c, edge.first);
+            }
+        }
+    }
+}
+
+}   // namespace Planning
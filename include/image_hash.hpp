@@ -0,0 +1,50 @@
+/** \file image_hash.hpp
+ * @brief Perceptual image hashing.
+ *
+ * A difference hash (dHash) summarizes the coarse structure of a frame in 64
+ * bits: the image is reduced to a 9x8 grayscale thumbnail and every bit
+ * tells whether a pixel is brighter than its right neighbour. Frames of the
+ * same scene from the same viewpoint have hashes at a small Hamming distance,
+ * regardless of sensor noise and small lighting changes.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "opencv2/imgproc.hpp"
+#include <cstdint>
+
+//! Image hashing utilities
+namespace ImageHash {
+
+/** Difference hash of an image.
+ * @param img BGR or grayscale image
+ * @return 64 bit hash
+*/
+uint64_t dHash(const cv::Mat& img) {
+    cv::Mat gray, thumb;
+    if (img.channels() == 3)
+        cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
+    else
+        gray = img;
+    cv::resize(gray, thumb, cv::Size(9, 8), 0, 0, cv::INTER_AREA);
+
+    uint64_t hash = 0;
+    for (int y = 0; y < 8; ++y) {
+        const uchar* row = thumb.ptr<uchar>(y);
+        for (int x = 0; x < 8; ++x)
+            hash = (hash << 1) | (row[x] > row[x+1] ? 1 : 0);
+    }
+    return hash;
+}
+
+/** Number of different bits of two hashes.
+ * @param a first hash
+ * @param b second hash
+ * @return Hamming distance (0-64)
+*/
+int hamming(uint64_t a, uint64_t b) {
+    return __builtin_popcountll(a ^ b);
+}
+
+}   // namespace ImageHash
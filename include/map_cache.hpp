@@ -0,0 +1,312 @@
+/** \file map_cache.hpp
+ * @brief Arena map cache with change detection.
+ *
+ * The arena layout rarely changes from one run to the next. The last
+ * processed arena image is stored with the obstacles, victims and gate found
+ * on it; a new arena image is compared with it on a grid of cells and only
+ * the regions whose cells differ have to be processed again.
+ *
+ * polygon refers to the Polygon objects from the AppliedRoboticsEnvironment(*).
+ *
+ * (*)  https://github.com/ValerioMa/AppliedRoboticsEnvironment/blob/master/src/9_project_interface/include/utils.hpp
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "opencv2/imgcodecs.hpp"
+#include "opencv2/imgproc.hpp"
+#include "coarse_detection.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+//! Arena map cache utilities
+namespace MapCache {
+
+/** Processed arena map. */
+struct Snapshot {
+    cv::Mat image;                                  ///< Arena image (BGR).
+    double scale = 0;                               ///< Scaling factor of the polygons.
+    uint64_t configKey = 0;                         ///< Key of the detection configuration it was processed with.
+    std::vector<Polygon> obstacles;                 ///< Inflated obstacles.
+    std::vector<std::pair<int,Polygon>> victims;    ///< Victims and their digit.
+    Polygon gate;                                   ///< Gate (empty if not found).
+};
+
+const uint64_t KEY_SEED = 14695981039346656037ULL;  ///< Key of no data (64 bit FNV-1a offset basis).
+
+/** Adds bytes to a key (64 bit FNV-1a).
+ * @param key key of the previous data (KEY_SEED to start)
+ * @param data bytes to add
+ * @param size number of bytes
+ * @return key of the previous data followed by data
+*/
+uint64_t addToKey(uint64_t key, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        key ^= bytes[i];
+        key *= 1099511628211ULL;
+    }
+    return key;
+}
+
+/** Adds a value to a key.
+ * @param key key of the previous data
+ * @param value value to add (its bytes)
+ * @return updated key
+*/
+template <typename T>
+uint64_t addValueToKey(uint64_t key, const T& value) {
+    return addToKey(key, &value, sizeof(value));
+}
+
+/** Adds a file content to a key.
+ * A missing file gives a different key than an empty one.
+ * @param key key of the previous data
+ * @param path file path
+ * @return updated key
+*/
+uint64_t addFileToKey(uint64_t key, const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open())
+        return addValueToKey(key, static_cast<uint64_t>(-1));
+    const std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    key = addValueToKey(key, static_cast<uint64_t>(content.size()));
+    return addToKey(key, content.data(), content.size());
+}
+
+/** Finds the regions that differ between two images.
+ * A pixel changes if any channel differs by more than threshold; a cell
+ * changes if more than fraction of its pixels change. Changed cells are
+ * grouped in non overlapping rectangles, padded by one cell.
+ * @param previous reference image
+ * @param current new image
+ * @param threshold per channel difference threshold
+ * @param cell cell side (pixels)
+ * @param fraction fraction of changed pixels of a changed cell
+ * @return changed regions (the whole frame if sizes or types differ)
+*/
+std::vector<cv::Rect> changedRegions(const cv::Mat& previous, const cv::Mat& current,
+                                     int threshold, int cell, double fraction) {
+    const cv::Rect frame(cv::Point(0, 0), current.size());
+    if ((previous.size() != current.size()) || (previous.type() != current.type()))
+        return {frame};
+
+    cv::Mat diff, unchanged, cells;
+    cv::absdiff(previous, current, diff);
+    cv::inRange(diff, cv::Scalar::all(0), cv::Scalar::all(threshold), unchanged);
+    // mean of the unchanged mask on every cell
+    cv::resize(unchanged, cells, cv::Size((frame.width + cell - 1) / cell,
+                                          (frame.height + cell - 1) / cell),
+               0, 0, cv::INTER_AREA);
+    cv::threshold(cells, cells, 255 * (1 - fraction), 255, cv::THRESH_BINARY_INV);
+
+    std::vector<std::vector<cv::Point>> contours;
+    cv::findContours(cells, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+
+    std::vector<cv::Rect> regions;
+    for (const std::vector<cv::Point>& contour : contours) {
+        const cv::Rect r = cv::boundingRect(contour);
+        cv::Rect full((r.x - 1) * cell, (r.y - 1) * cell, (r.width + 2) * cell, (r.height + 2) * cell);
+        full &= frame;
+        if (full.area() > 0)
+            regions.push_back(full);
+    }
+    CoarseDetection::mergeOverlapping(regions);
+    return regions;
+}
+
+/** Bounding box of a polygon in pixels.
+ * @param polygon polygon (meters)
+ * @param scale scaling factor (pixels per meter)
+ * @return enclosing pixel rectangle
+*/
+cv::Rect pixelBox(const Polygon& polygon, double scale) {
+    if (polygon.empty())
+        return cv::Rect();
+    float minX = polygon[0].x, maxX = polygon[0].x;
+    float minY = polygon[0].y, maxY = polygon[0].y;
+    for (const auto& p : polygon) {
+        minX = std::min(minX, p.x);
+        maxX = std::max(maxX, p.x);
+        minY = std::min(minY, p.y);
+        maxY = std::max(maxY, p.y);
+    }
+    return cv::Rect(cv::Point(std::floor(minX * scale), std::floor(minY * scale)),
+                    cv::Point(std::ceil(maxX * scale) + 1, std::ceil(maxY * scale) + 1));
+}
+
+/** Checks whether a rectangle overlaps any region.
+ * @param box rectangle
+ * @param regions regions
+ * @return true if box overlaps at least one region
+*/
+bool overlaps(const cv::Rect& box, const std::vector<cv::Rect>& regions) {
+    for (const cv::Rect& r : regions)
+        if ((box & r).area() > 0)
+            return true;
+    return false;
+}
+
+/** Checks whether a rectangle lies inside a region without touching its
+ * borders (borders on the frame border excluded).
+ * An object found touching a region border may continue outside it.
+ * @param box rectangle
+ * @param regions regions
+ * @param frame image frame
+ * @return true if box is strictly inside one region
+*/
+bool inside(const cv::Rect& box, const std::vector<cv::Rect>& regions, const cv::Rect& frame) {
+    for (const cv::Rect& r : regions) {
+        const int left   = (r.x == frame.x) ? r.x : r.x + 1;
+        const int top    = (r.y == frame.y) ? r.y : r.y + 1;
+        const int right  = (r.br().x == frame.br().x) ? r.br().x : r.br().x - 1;
+        const int bottom = (r.br().y == frame.br().y) ? r.br().y : r.br().y - 1;
+        if ((box.x >= left) && (box.y >= top) && (box.br().x <= right) && (box.br().y <= bottom))
+            return true;
+    }
+    return false;
+}
+
+/** Grows regions until they cover every box they overlap.
+ * @param regions regions (modified in place, non overlapping on return)
+ * @param boxes boxes of the objects that must not be cut by a region
+ * @param padding padding of the covered boxes (pixels)
+ * @param frame image frame
+*/
+void growRegions(std::vector<cv::Rect>& regions, const std::vector<cv::Rect>& boxes,
+                 int padding, const cv::Rect& frame) {
+    bool grown = true;
+    while (grown) {
+        grown = false;
+        for (const cv::Rect& box : boxes) {
+            const cv::Rect padded = cv::Rect(box.x - padding, box.y - padding,
+                                             box.width + 2 * padding,
+                                             box.height + 2 * padding) & frame;
+            for (cv::Rect& r : regions) {
+                if (((box & r).area() > 0) && ((r | padded) != r)) {
+                    r |= padded;
+                    grown = true;
+                }
+            }
+        }
+        CoarseDetection::mergeOverlapping(regions);
+    }
+}
+
+/** Total area of non overlapping regions.
+ * @param regions regions
+ * @return area (pixels)
+*/
+int totalArea(const std::vector<cv::Rect>& regions) {
+    int area = 0;
+    for (const cv::Rect& r : regions)
+        area += r.area();
+    return area;
+}
+
+/** Converts a polygon to a Nx2 float matrix. */
+cv::Mat toMat(const Polygon& polygon) {
+    cv::Mat m(polygon.size(), 2, CV_32F);
+    for (size_t i = 0; i < polygon.size(); ++i) {
+        m.at<float>(i, 0) = polygon[i].x;
+        m.at<float>(i, 1) = polygon[i].y;
+    }
+    return m;
+}
+
+/** Converts a Nx2 float matrix to a polygon. */
+Polygon toPolygon(const cv::Mat& m) {
+    Polygon polygon;
+    for (int i = 0; i < m.rows; ++i)
+        polygon.emplace_back(m.at<float>(i, 0), m.at<float>(i, 1));
+    return polygon;
+}
+
+/** Loads a snapshot.
+ * @param image_path arena image path
+ * @param data_path map data path (YAML)
+ * @param snapshot output snapshot
+ * @return false if the files do not exist or are not valid
+*/
+bool load(const std::string& image_path, const std::string& data_path, Snapshot& snapshot) {
+    cv::FileStorage fs;
+    try {
+        if (!fs.open(data_path, cv::FileStorage::READ))
+            return false;
+        std::string key;
+        fs["scale"] >> snapshot.scale;
+        fs["config_key"] >> key;
+        std::istringstream(key) >> std::hex >> snapshot.configKey;
+
+        snapshot.obstacles.clear();
+        cv::FileNode obstacles = fs["obstacles"];
+        for (cv::FileNodeIterator it = obstacles.begin(); it != obstacles.end(); ++it) {
+            cv::Mat m;
+            *it >> m;
+            snapshot.obstacles.push_back(toPolygon(m));
+        }
+
+        snapshot.victims.clear();
+        std::vector<int> ids;
+        fs["victim_ids"] >> ids;
+        cv::FileNode victims = fs["victims"];
+        size_t i = 0;
+        for (cv::FileNodeIterator it = victims.begin(); (it != victims.end()) && (i < ids.size()); ++it, ++i) {
+            cv::Mat m;
+            *it >> m;
+            snapshot.victims.emplace_back(ids[i], toPolygon(m));
+        }
+
+        cv::Mat gate;
+        fs["gate"] >> gate;
+        snapshot.gate = toPolygon(gate);
+    } catch (const cv::Exception&) {
+        return false;
+    }
+    snapshot.image = cv::imread(image_path, cv::IMREAD_COLOR);
+    return !snapshot.image.empty() && (snapshot.scale > 0);
+}
+
+/** Saves a snapshot.
+ * @param image_path arena image path (lossless format, e.g. PNG)
+ * @param data_path map data path (YAML)
+ * @param snapshot snapshot to save
+*/
+void save(const std::string& image_path, const std::string& data_path, const Snapshot& snapshot) {
+    if (!cv::imwrite(image_path, snapshot.image))
+        throw std::runtime_error("Cannot write file: " + image_path);
+
+    cv::FileStorage fs(data_path, cv::FileStorage::WRITE);
+    if (!fs.isOpened())
+        throw std::runtime_error("Cannot write file: " + data_path);
+    std::ostringstream key;
+    key << std::hex << snapshot.configKey;
+    fs << "scale" << snapshot.scale;
+    fs << "config_key" << key.str();
+
+    fs << "obstacles" << "[";
+    for (const Polygon& p : snapshot.obstacles)
+        fs << toMat(p);
+    fs << "]";
+
+    std::vector<int> ids;
+    fs << "victims" << "[";
+    for (const std::pair<int,Polygon>& v : snapshot.victims) {
+        ids.push_back(v.first);
+        fs << toMat(v.second);
+    }
+    fs << "]";
+    fs << "victim_ids" << ids;
+    fs << "gate" << toMat(snapshot.gate);
+}
+
+}   // namespace MapCache
@@ -0,0 +1,177 @@
+/** \file morphology.hpp
+ * @brief Large kernel binary dilation.
+ *
+ * Obstacles are inflated by the robot size, i.e. with structuring elements
+ * that are 100+ pixels wide at the arena scale. cv::dilate cost grows with
+ * the kernel size, the methods here have a constant cost per pixel:
+ * - rectangles use the separable van Herk/Gil-Werman running max (3
+ *   comparisons per pixel and per direction, whatever the kernel size);
+ * - disks threshold the exact euclidean distance transform of the
+ *   background, which gives the circular footprint of the robot instead of
+ *   the square that over-inflates obstacles along the diagonals.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "opencv2/imgproc.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+//! Morphology utilities
+namespace Morphology {
+
+enum class Footprint { rect, disk }; ///< Dilation structuring element shapes.
+
+/** Running max of a line (van Herk/Gil-Werman).
+ * dst[x] = max(src[x - anchor], ..., src[x - anchor + k - 1]), pixels
+ * outside the line count as 0 (same as the cv::dilate default border).
+ * The padded line is split in blocks of k pixels: g holds the prefix max and
+ * h the suffix max of every block, so every window is max(h[x], g[x + k - 1]).
+ * @param src input line
+ * @param n line length
+ * @param k window size
+ * @param anchor window anchor
+ * @param dst output line (must not alias src)
+ * @param p padded line buffer
+ * @param g prefix max buffer
+ * @param h suffix max buffer
+*/
+void runningMaxLine(const uchar* src, int n, int k, int anchor, uchar* dst,
+                    std::vector<uchar>& p, std::vector<uchar>& g,
+                    std::vector<uchar>& h) {
+    const int len = ((n + k - 1 + k - 1) / k) * k;  // padded length, whole blocks
+    p.assign(len, 0);
+    g.resize(len);
+    h.resize(len);
+    std::copy(src, src + n, p.begin() + anchor);
+
+    for (int b = 0; b < len; b += k) {
+        const int e = b + k - 1;
+        g[b] = p[b];
+        for (int j = b + 1; j <= e; ++j)
+            g[j] = std::max(g[j-1], p[j]);
+        h[e] = p[e];
+        for (int j = e - 1; j >= b; --j)
+            h[j] = std::max(h[j+1], p[j]);
+    }
+    for (int x = 0; x < n; ++x)
+        dst[x] = std::max(h[x], g[x + k - 1]);
+}
+
+/** Horizontal running max of every row.
+ * @param src 8-bit single channel input image
+ * @param dst output image
+ * @param k window width
+ * @param anchor window anchor
+*/
+void runningMaxRows(const cv::Mat& src, cv::Mat& dst, int k, int anchor) {
+    cv::Mat out(src.size(), CV_8UC1);
+    std::vector<uchar> p, g, h;
+    for (int y = 0; y < src.rows; ++y)
+        runningMaxLine(src.ptr<uchar>(y), src.cols, k, anchor, out.ptr<uchar>(y), p, g, h);
+    dst = out;
+}
+
+/** Vertical running max of every column.
+ * Same algorithm as runningMaxLine, applied to whole rows at a time so that
+ * memory is always accessed sequentially.
+ * @param src 8-bit single channel input image
+ * @param dst output image
+ * @param k window height
+ * @param anchor window anchor
+*/
+void runningMaxCols(const cv::Mat& src, cv::Mat& dst, int k, int anchor) {
+    const int n = src.rows;
+    const int cols = src.cols;
+    const int len = ((n + k - 1 + k - 1) / k) * k;
+    const std::vector<uchar> zeros(cols, 0);
+    auto padded = [&](int j) {
+        const int y = j - anchor;
+        return ((y >= 0) && (y < n)) ? src.ptr<uchar>(y) : zeros.data();
+    };
+
+    cv::Mat g(len, cols, CV_8UC1), h(len, cols, CV_8UC1);
+    for (int b = 0; b < len; b += k) {
+        const int e = b + k - 1;
+        std::copy(padded(b), padded(b) + cols, g.ptr<uchar>(b));
+        for (int j = b + 1; j <= e; ++j) {
+            const uchar* prev = g.ptr<uchar>(j-1);
+            const uchar* row = padded(j);
+            uchar* cur = g.ptr<uchar>(j);
+            for (int x = 0; x < cols; ++x)
+                cur[x] = std::max(prev[x], row[x]);
+        }
+        std::copy(padded(e), padded(e) + cols, h.ptr<uchar>(e));
+        for (int j = e - 1; j >= b; --j) {
+            const uchar* next = h.ptr<uchar>(j+1);
+            const uchar* row = padded(j);
+            uchar* cur = h.ptr<uchar>(j);
+            for (int x = 0; x < cols; ++x)
+                cur[x] = std::max(next[x], row[x]);
+        }
+    }
+
+    cv::Mat out(src.size(), CV_8UC1);
+    for (int y = 0; y < n; ++y) {
+        const uchar* hr = h.ptr<uchar>(y);
+        const uchar* gr = g.ptr<uchar>(y + k - 1);
+        uchar* o = out.ptr<uchar>(y);
+        for (int x = 0; x < cols; ++x)
+            o[x] = std::max(hr[x], gr[x]);
+    }
+    dst = out;
+}
+
+/** Dilation with a rectangular structuring element.
+ * Equivalent to cv::dilate with a MORPH_RECT kernel of the given size and
+ * default anchor (center) and border.
+ * @param src 8-bit single channel input image
+ * @param dst output image (can be src)
+ * @param size kernel size
+*/
+void dilateRect(const cv::Mat& src, cv::Mat& dst, const cv::Size& size) {
+    if (src.type() != CV_8UC1)
+        throw std::invalid_argument("Morphology: 8-bit single channel image expected");
+    if ((size.width <= 0) || (size.height <= 0))
+        throw std::invalid_argument("Morphology: invalid kernel size");
+    cv::Mat tmp;
+    runningMaxRows(src, tmp, size.width, size.width / 2);
+    runningMaxCols(tmp, dst, size.height, size.height / 2);
+}
+
+/** Dilation with a disk structuring element.
+ * A pixel is set if its euclidean distance from the nearest set pixel is at
+ * most radius.
+ * @param src 8-bit single channel binary input image
+ * @param dst output image (can be src)
+ * @param radius disk radius in pixels
+*/
+void dilateDisk(const cv::Mat& src, cv::Mat& dst, float radius) {
+    if (src.type() != CV_8UC1)
+        throw std::invalid_argument("Morphology: 8-bit single channel image expected");
+    cv::Mat background, dist;
+    cv::compare(src, 0, background, cv::CMP_EQ);  // distance to the set pixels
+    if (cv::countNonZero(background) == (int)background.total()) {
+        dst = cv::Mat::zeros(src.size(), CV_8UC1);
+        return;
+    }
+    cv::distanceTransform(background, dist, cv::DIST_L2, cv::DIST_MASK_PRECISE);
+    cv::compare(dist, radius, dst, cv::CMP_LE);
+}
+
+/** Binary dilation with a constant cost per pixel.
+ * @param src 8-bit single channel binary input image
+ * @param dst output image (can be src)
+ * @param shape structuring element shape
+ * @param size structuring element width (side of the square, diameter of the disk)
+*/
+void dilate(const cv::Mat& src, cv::Mat& dst, Footprint shape, int size) {
+    if (shape == Footprint::rect)
+        dilateRect(src, dst, cv::Size(size, size));
+    else
+        dilateDisk(src, dst, size / 2.0f);
+}
+
+}   // namespace Morphology
@@ -0,0 +1,86 @@
+/** \file parallel_utils.hpp
+ * @brief Minimal thread-pool helpers.
+ *
+ * Small utilities used to spread independent work items (e.g. one victim ROI
+ * per item) over the available cores with plain std::thread workers.
+ * Every worker gets its own index so callers can keep per-worker scratch
+ * buffers without locking.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! Parallel execution utilities
+namespace ParallelUtils {
+
+/** Number of workers to use for a given amount of work.
+ * @param items number of work items
+ * @param maxThreads upper bound for the number of threads (0 = hardware concurrency)
+ * @return number of workers (at least 1, at most items)
+*/
+unsigned int workerCount(size_t items, unsigned int maxThreads = 0) {
+    unsigned int hw = std::thread::hardware_concurrency();
+    if (hw == 0)
+        hw = 1;
+    unsigned int n = (maxThreads == 0) ? hw : maxThreads;
+    if (n > items)
+        n = static_cast<unsigned int>(items);
+    return (n == 0) ? 1 : n;
+}
+
+/** Run body(i, worker) for every i in [0, items).
+ * Items are handed out dynamically (atomic counter) so that slow items do not
+ * stall a whole static chunk. The call blocks until every item is processed.
+ * With a single worker the body runs on the calling thread.
+ * If a body throws, the remaining items are skipped and the first exception is
+ * rethrown on the calling thread once all workers have stopped.
+ *
+ * @param items number of work items
+ * @param body function called with the item index and the worker index
+ * @param maxThreads upper bound for the number of threads (0 = hardware concurrency)
+*/
+void parallelFor(size_t items, const std::function<void(size_t, unsigned int)>& body,
+                 unsigned int maxThreads = 0) {
+    const unsigned int workers = workerCount(items, maxThreads);
+
+    if (workers <= 1) {
+        for (size_t i = 0; i < items; ++i)
+            body(i, 0);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto worker = [&](unsigned int w) {
+        for (size_t i = next++; i < items; i = next++) {
+            try {
+                body(i, w);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error)
+                    error = std::current_exception();
+                next = items;   // stop handing out work
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned int w = 1; w < workers; ++w)
+        pool.emplace_back(worker, w);
+    worker(0);  // the calling thread works too
+    for (std::thread& t : pool)
+        t.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+}   // namespace ParallelUtils
@@ -0,0 +1,150 @@
+/** \file planner_worker.hpp
+ * @brief Client of a persistent planner worker process.
+ *
+ * The worker (src/path-planning/rrt_worker.py) is started once and serves
+ * one planning problem at a time over a Unix socket connected to its
+ * standard input and output, so the interpreter startup, the imports and the
+ * text files of the one-shot script are paid once per session.
+ *
+ * Frames are little-endian int32 values, coordinates are scaled to integers:
+ * - on start the worker writes MAGIC;
+ * - request: borders (count, x, y, ...), obstacle count, every obstacle
+ *   (count, x, y, ...), start x, start y, goal x, goal y;
+ * - response: path point count (-1 if no path was found), x, y, ...
+ *
+ * polygon refers to the Polygon objects from the AppliedRoboticsEnvironment(*).
+ *
+ * (*)  https://github.com/ValerioMa/AppliedRoboticsEnvironment/blob/master/src/9_project_interface/include/utils.hpp
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "process_utils.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+/** Connection to a planner worker process. Requests are serialized. */
+class PlannerWorker {
+public:
+    /** Starts the worker and waits until it is ready.
+     * @param command program name and arguments of the worker
+     * @param scale factor from meters to the integer worker coordinates
+    */
+    PlannerWorker(const std::vector<std::string>& command, float scale) : scale(scale) {
+        pid = ProcessUtils::spawnConnected(command, connection);
+        int32_t magic = 0;
+        try {
+            receive(&magic, 1);
+        } catch (const std::runtime_error&) {
+            close(connection);
+            ProcessUtils::terminate(pid);
+            throw;
+        }
+        if (magic != MAGIC) {
+            close(connection);
+            ProcessUtils::terminate(pid);
+            throw std::runtime_error("Not a planner worker: " + command[0]);
+        }
+    }
+
+    PlannerWorker(const PlannerWorker&) = delete;
+    PlannerWorker& operator=(const PlannerWorker&) = delete;
+
+    /** Stops the worker. */
+    ~PlannerWorker() {
+        close(connection);
+        ProcessUtils::terminate(pid);
+    }
+
+    /** Plans a path.
+     * Throws std::runtime_error if the worker stopped (see running()).
+     * @param borders borders of the arena
+     * @param obstacles obstacle polygons
+     * @param start starting point
+     * @param goal arrival point
+     * @param path output path points, from start to goal
+     * @return false if the worker did not find a path
+    */
+    bool plan(const Polygon& borders, const std::vector<Polygon>& obstacles,
+              const Point& start, const Point& goal, std::vector<Point>& path) {
+        std::vector<int32_t> request;
+        append(request, borders);
+        request.push_back(obstacles.size());
+        for (const Polygon& obstacle : obstacles)
+            append(request, obstacle);
+        append(request, start);
+        append(request, goal);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        send(request);
+        int32_t count;
+        receive(&count, 1);
+        path.clear();
+        if (count < 0)
+            return false;
+        std::vector<int32_t> values(2 * count);
+        receive(values.data(), values.size());
+        for (int32_t i = 0; i < count; ++i)
+            path.emplace_back(values[2*i] / scale, values[2*i+1] / scale);
+        return true;
+    }
+
+    bool running() const { return !stopped; }  ///< False once the worker stopped answering.
+
+private:
+    void append(std::vector<int32_t>& frame, const Point& p) const {
+        frame.push_back(static_cast<int32_t>(p.x * scale));
+        frame.push_back(static_cast<int32_t>(p.y * scale));
+    }
+
+    void append(std::vector<int32_t>& frame, const Polygon& polygon) const {
+        frame.push_back(polygon.size());
+        for (const Point& p : polygon)
+            append(frame, p);
+    }
+
+    /** Writes a frame to the worker (no SIGPIPE if it stopped). */
+    void send(const std::vector<int32_t>& frame) {
+        const char* data = reinterpret_cast<const char*>(frame.data());
+        size_t left = frame.size() * sizeof(int32_t);
+        while (left > 0) {
+            const ssize_t sent = ::send(connection, data, left, MSG_NOSIGNAL);
+            if (sent <= 0) {
+                stopped = true;
+                throw std::runtime_error("Planner worker stopped");
+            }
+            data += sent;
+            left -= sent;
+        }
+    }
+
+    /** Reads exactly count values from the worker. */
+    void receive(int32_t* values, size_t count) {
+        char* data = reinterpret_cast<char*>(values);
+        size_t left = count * sizeof(int32_t);
+        while (left > 0) {
+            const ssize_t got = ::recv(connection, data, left, 0);
+            if (got <= 0) {
+                stopped = true;
+                throw std::runtime_error("Planner worker stopped");
+            }
+            data += got;
+            left -= got;
+        }
+    }
+
+    static constexpr int32_t MAGIC = 0x57545252;   ///< "RRTW" written by the worker on start.
+
+    float scale;                        ///< Meters to worker coordinates.
+    pid_t pid;                          ///< Worker process.
+    int connection;                     ///< Parent end of the worker socket.
+    std::atomic<bool> stopped{false};   ///< The worker stopped answering (running() reads it without the lock).
+    std::mutex mutex;                   ///< Serializes the requests.
+};
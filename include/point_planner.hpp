@@ -0,0 +1,64 @@
+/** \file point_planner.hpp
+ * @brief Common interface of the native point planners.
+ *
+ * A point planner finds a collision free polyline between two points of an
+ * arena. It is built once per map (borders and obstacles) and then answers
+ * any number of queries.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//! Point path planning
+namespace Planning {
+
+/** Point planner interface. */
+class PointPlanner {
+public:
+    virtual ~PointPlanner() {}
+
+    /** Plans a path.
+     * Throws std::runtime_error("Path not found!") if there is no path.
+     * @param start start point
+     * @param goal goal point
+     * @return path vertices, from start to goal (both included)
+    */
+    virtual std::vector<Point> plan(const Point& start, const Point& goal) = 0;
+
+    /** @return planner name (for debug and benchmarks) */
+    virtual std::string name() const = 0;
+
+    /** @return sampling iterations of the last query (0 for roadmap planners) */
+    virtual size_t lastIterations() const { return 0; }
+
+    /** Path lengths from a point to several targets.
+     * The default plans every target; roadmap planners search once.
+     * @param source source point
+     * @param targets target points
+     * @return path length of every target (infinity if unreachable)
+    */
+    virtual std::vector<double> distancesFrom(const Point& source, const std::vector<Point>& targets) {
+        std::vector<double> result;
+        for (const Point& target : targets) {
+            double length = std::numeric_limits<double>::infinity();
+            try {
+                const std::vector<Point> path = plan(source, target);
+                length = 0;
+                for (size_t i = 1; i < path.size(); ++i)
+                    length += std::hypot(path[i].x - path[i-1].x, path[i].y - path[i-1].y);
+            } catch (const std::runtime_error&) {
+                // unreachable
+            }
+            result.push_back(length);
+        }
+        return result;
+    }
+};
+
+}   // namespace Planning
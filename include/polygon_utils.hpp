@@ -155,4 +155,23 @@ namespace PUtils {
         return ((pa.x == pb.x)&&(pa.y == pb.y));
     }
 
+    /** return true if two polygon lists have the same vertices, in the same order.
+     *
+     * @param a first list
+     * @param b second list
+     * @return true if the lists are equal
+    */
+    bool polygonsEqual(const std::vector<Polygon>& a, const std::vector<Polygon>& b){
+        if (a.size() != b.size())
+            return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].size() != b[i].size())
+                return false;
+            for (size_t j = 0; j < a[i].size(); ++j)
+                if (!pointsEquals(a[i][j], b[i][j]))
+                    return false;
+        }
+        return true;
+    }
+
 }    // namespace PUtils
@@ -0,0 +1,299 @@
+/** \file prm.hpp
+ * @brief Probabilistic roadmap point planner.
+ *
+ * All the queries of a mission run on the same map, so the roadmap is
+ * sampled once per map: free samples are drawn in parallel and every sample
+ * is connected to its nearest neighbours (see PointGrid). A query connects
+ * its endpoints to the roadmap and runs A*.
+ *
+ * The roadmap can be saved to a binary file keyed by the map geometry and
+ * the roadmap parameters, so a restart on the same map skips the
+ * construction. Sampling is split in fixed chunks with their own seeds, so
+ * the roadmap does not depend on the number of threads.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "collision_checker.hpp"
+#include "graph_search.hpp"
+#include "parallel_utils.hpp"
+#include "point_planner.hpp"
+#include "spatial_grid.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+//! Point path planning
+namespace Planning {
+
+/** Probabilistic roadmap planner. */
+class ProbabilisticRoadmap : public PointPlanner {
+public:
+    /** Roadmap parameters. */
+    struct Parameters {
+        size_t samples = 1500;          ///< Free samples.
+        size_t neighbours = 10;         ///< Nearest samples every sample is connected to.
+        uint32_t seed = 1;              ///< Random seed.
+        unsigned int threads = 0;       ///< Construction threads (0 = hardware concurrency).
+    };
+
+    /** Creates an empty roadmap (see build and load).
+     * @param checker collision checker of the arena
+     * @param parameters roadmap parameters
+    */
+    ProbabilisticRoadmap(const CollisionChecker& checker, const Parameters& parameters)
+        : checker(checker), parameters(parameters),
+          grid(checker.minXBound(), checker.minYBound(), checker.maxXBound(), checker.maxYBound(), GRID_CELL),
+          mapKey(geometryKey(checker, parameters)) {}
+
+    /** Samples and connects the roadmap. */
+    void build() {
+        // free samples, chunk by chunk
+        const size_t chunks = (parameters.samples + SAMPLE_CHUNK - 1) / SAMPLE_CHUNK;
+        std::vector<std::vector<Point>> sampled(chunks);
+        ParallelUtils::parallelFor(chunks, [&](size_t c, unsigned int) {
+            std::seed_seq seq{parameters.seed, static_cast<uint32_t>(c)};
+            std::mt19937 rng(seq);
+            std::uniform_real_distribution<float> x(checker.minXBound(), checker.maxXBound());
+            std::uniform_real_distribution<float> y(checker.minYBound(), checker.maxYBound());
+            size_t wanted = parameters.samples - c * SAMPLE_CHUNK;
+            if (wanted > SAMPLE_CHUNK)
+                wanted = SAMPLE_CHUNK;
+            for (size_t attempt = 0; (sampled[c].size() < wanted) && (attempt < wanted * MAX_REJECTIONS); ++attempt) {
+                const Point p(x(rng), y(rng));
+                if (checker.pointFree(p))
+                    sampled[c].push_back(p);
+            }
+        }, parameters.threads);
+
+        for (const std::vector<Point>& chunk : sampled)
+            for (const Point& p : chunk) {
+                grid.insert(p);
+                roadmap.addNode();
+            }
+
+        // free edges to the nearest samples
+        std::vector<std::vector<int>> linked(grid.size());
+        ParallelUtils::parallelFor(grid.size(), [&](size_t i, unsigned int) {
+            for (int j : grid.kNearest(grid.point(i), parameters.neighbours + 1))
+                if ((j != static_cast<int>(i)) && checker.segmentFree(grid.point(i), grid.point(j)))
+                    linked[i].push_back(j);
+        }, parameters.threads);
+
+        std::vector<std::pair<int, int>> edges;
+        for (size_t i = 0; i < linked.size(); ++i)
+            for (int j : linked[i])
+                edges.emplace_back(std::min<int>(i, j), std::max<int>(i, j));
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+        for (const std::pair<int, int>& e : edges)
+            roadmap.addEdge(e.first, e.second, distance(grid.point(e.first), grid.point(e.second)));
+    }
+
+    /** Loads a roadmap saved for the same map and parameters.
+     * @param path roadmap file path
+     * @return false if the file does not exist or does not match
+    */
+    bool load(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open())
+            return false;
+        uint32_t magic;
+        uint64_t key;
+        uint32_t counts[2];     // nodes, edges
+        if (!in.read(reinterpret_cast<char*>(&magic), sizeof(magic)) || (magic != FILE_MAGIC) ||
+            !in.read(reinterpret_cast<char*>(&key), sizeof(key)) || (key != mapKey) ||
+            !in.read(reinterpret_cast<char*>(counts), sizeof(counts)))
+            return false;
+
+        std::vector<float> coordinates(2 * counts[0]);
+        std::vector<int32_t> edges(2 * counts[1]);
+        if (!in.read(reinterpret_cast<char*>(coordinates.data()), coordinates.size() * sizeof(float)) ||
+            !in.read(reinterpret_cast<char*>(edges.data()), edges.size() * sizeof(int32_t)))
+            return false;
+        for (int32_t n : edges)
+            if ((n < 0) || (n >= static_cast<int32_t>(counts[0])))
+                return false;
+
+        for (size_t i = 0; i < counts[0]; ++i) {
+            grid.insert(Point(coordinates[2 * i], coordinates[2 * i + 1]));
+            roadmap.addNode();
+        }
+        for (size_t e = 0; e < counts[1]; ++e)
+            roadmap.addEdge(edges[2 * e], edges[2 * e + 1],
+                            distance(grid.point(edges[2 * e]), grid.point(edges[2 * e + 1])));
+        return true;
+    }
+
+    /** Saves the roadmap.
+     * @param path roadmap file path
+    */
+    void save(const std::string& path) const {
+        std::ofstream out(path, std::ios::binary);
+        if (!out.is_open())
+            throw std::runtime_error("Cannot write file: " + path);
+
+        std::vector<float> coordinates;
+        for (size_t i = 0; i < grid.size(); ++i) {
+            coordinates.push_back(grid.point(i).x);
+            coordinates.push_back(grid.point(i).y);
+        }
+        std::vector<int32_t> edges;
+        for (size_t a = 0; a < roadmap.size(); ++a)
+            for (const auto& e : roadmap.adjacency[a])
+                if (static_cast<int>(a) < e.first) {
+                    edges.push_back(a);
+                    edges.push_back(e.first);
+                }
+        const uint32_t counts[2] = { static_cast<uint32_t>(grid.size()), static_cast<uint32_t>(edges.size() / 2) };
+
+        const uint32_t magic = FILE_MAGIC;
+        out.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+        out.write(reinterpret_cast<const char*>(&mapKey), sizeof(mapKey));
+        out.write(reinterpret_cast<const char*>(counts), sizeof(counts));
+        out.write(reinterpret_cast<const char*>(coordinates.data()), coordinates.size() * sizeof(float));
+        out.write(reinterpret_cast<const char*>(edges.data()), edges.size() * sizeof(int32_t));
+        if (!out)
+            throw std::runtime_error("Cannot write file: " + path);
+    }
+
+    std::vector<Point> plan(const Point& start, const Point& goal) override {
+        if (checker.segmentFreeFrom(start, goal) && checker.segmentFreeFrom(goal, start))
+            return {start, goal};
+
+        Graph g = roadmap;
+        std::vector<Point> nodes = points();
+        const int s = connect(g, nodes, start);
+        const int t = connect(g, nodes, goal);
+
+        std::vector<int> route;
+        if (!aStar(g, s, t, [&](int n) { return distance(nodes[n], goal); }, route))
+            throw std::runtime_error("Path not found!");
+
+        std::vector<Point> path;
+        for (int n : route)
+            path.push_back(nodes[n]);
+        return path;
+    }
+
+    std::string name() const override { return "probabilistic roadmap"; }
+
+    /** Roadmap path lengths from a point to several targets (one Dijkstra run).
+     * @param source source point
+     * @param targets target points
+     * @return roadmap path length of every target (infinity if unreachable)
+    */
+    std::vector<double> distancesFrom(const Point& source, const std::vector<Point>& targets) override {
+        std::vector<double> result(targets.size(), std::numeric_limits<double>::infinity());
+        Graph g = roadmap;
+        std::vector<Point> nodes = points();
+        const int s = connect(g, nodes, source);
+        std::vector<double> cost;
+        std::vector<int> parent;
+        dijkstra(g, s, cost, parent);
+
+        for (size_t k = 0; k < targets.size(); ++k) {
+            if (checker.segmentFreeFrom(source, targets[k]) && checker.segmentFreeFrom(targets[k], source)) {
+                result[k] = distance(source, targets[k]);
+                continue;
+            }
+            // last hop from the samples the target connects to
+            for (int n : visibleSamples(targets[k]))
+                result[k] = std::min(result[k], cost[n] + distance(grid.point(n), targets[k]));
+        }
+        return result;
+    }
+
+    uint64_t key() const { return mapKey; }                     ///< Key of the map and parameters.
+    size_t nodeCount() const { return roadmap.size(); }         ///< Number of samples.
+    size_t edgeCount() const { return roadmap.edgeCount(); }    ///< Number of roadmap edges.
+
+private:
+    /** Key of a map geometry and of the roadmap parameters (64 bit FNV-1a).
+     * @param checker collision checker of the arena
+     * @param parameters roadmap parameters
+     * @return the key
+    */
+    static uint64_t geometryKey(const CollisionChecker& checker, const Parameters& parameters) {
+        uint64_t key = 14695981039346656037ULL;
+        auto add = [&key](const void* data, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                key ^= static_cast<const unsigned char*>(data)[i];
+                key *= 1099511628211ULL;
+            }
+        };
+        auto addPolygon = [&add](const Polygon& polygon) {
+            const uint32_t n = polygon.size();
+            add(&n, sizeof(n));
+            for (const Point& p : polygon) {
+                add(&p.x, sizeof(p.x));
+                add(&p.y, sizeof(p.y));
+            }
+        };
+        addPolygon(checker.borders());
+        for (const Polygon& obstacle : checker.obstacles())
+            addPolygon(obstacle);
+        const uint64_t values[3] = { parameters.samples, parameters.neighbours, parameters.seed };
+        add(values, sizeof(values));
+        return key;
+    }
+
+    /** @return the roadmap samples */
+    std::vector<Point> points() const {
+        std::vector<Point> nodes;
+        for (size_t i = 0; i < grid.size(); ++i)
+            nodes.push_back(grid.point(i));
+        return nodes;
+    }
+
+    /** Finds the nearest samples a query point can be connected to.
+     * Looks at more samples when none of the nearest is visible.
+     * @param p query point
+     * @return visible samples
+    */
+    std::vector<int> visibleSamples(const Point& p) const {
+        std::vector<int> visible;
+        for (size_t k = std::max<size_t>(parameters.neighbours, 1); visible.empty(); k *= 4) {
+            for (int n : grid.kNearest(p, k))
+                if (checker.segmentFreeFrom(p, grid.point(n)))
+                    visible.push_back(n);
+            if (k >= grid.size())
+                break;
+        }
+        return visible;
+    }
+
+    /** Adds a query point to a copy of the roadmap.
+     * @param g roadmap copy
+     * @param nodes points of the roadmap copy
+     * @param p query point
+     * @return node of the query point
+    */
+    int connect(Graph& g, std::vector<Point>& nodes, const Point& p) const {
+        const int id = g.addNode();
+        nodes.push_back(p);
+        for (int n : visibleSamples(p))
+            g.addEdge(id, n, distance(p, grid.point(n)));
+        return id;
+    }
+
+    static constexpr size_t SAMPLE_CHUNK = 256;         ///< Samples drawn by one task.
+    static constexpr size_t MAX_REJECTIONS = 50;        ///< Attempts per sample before giving up.
+    static constexpr float GRID_CELL = 0.05f;           ///< Neighbour index cell (m).
+    static constexpr uint32_t FILE_MAGIC = 0x314d5250;  ///< "PRM1".
+
+    const CollisionChecker checker;     ///< Arena collision checker.
+    const Parameters parameters;        ///< Roadmap parameters.
+    PointGrid grid;                     ///< Samples and their index.
+    Graph roadmap;                      ///< Roadmap edges.
+    const uint64_t mapKey;              ///< Key of the map and parameters.
+};
+
+}   // namespace Planning
@@ -0,0 +1,180 @@
+/** \file process_utils.hpp
+ * @brief Minimal child process helpers.
+ *
+ * Small POSIX utilities used to run external planner scripts: unique
+ * temporary files for the data exchange, so concurrent calls never share a
+ * file, non-blocking start, poll and kill of child processes, so several
+ * instances can run at the same time, and children connected through a
+ * socket for long-lived workers. ChildGroup kills the children and removes
+ * the files it owns when it goes out of scope.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include <cstdio>
+#include <experimental/filesystem>
+#include <signal.h>
+#include <spawn.h>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+extern char **environ;
+
+//! Child process utilities
+namespace ProcessUtils {
+
+/** Creates an empty file with a unique name in the temporary directory.
+ * @param prefix file name prefix
+ * @return the file path
+*/
+std::string temporaryFile(const std::string& prefix) {
+    std::string path = (std::experimental::filesystem::temp_directory_path() / (prefix + "XXXXXX")).string();
+    const int fd = mkstemp(&path[0]);
+    if (fd == -1)
+        throw std::runtime_error("Cannot write file: " + path);
+    close(fd);
+    return path;
+}
+
+/** Starts a program, searched in PATH. The child inherits the standard streams.
+ * @param args program name and arguments
+ * @return the child process id
+*/
+pid_t spawn(const std::vector<std::string>& args) {
+    std::vector<char*> argv;
+    for (const std::string& a : args)
+        argv.push_back(const_cast<char*>(a.c_str()));
+    argv.push_back(nullptr);
+
+    pid_t pid;
+    if (posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ) != 0)
+        throw std::runtime_error("Cannot start " + args[0]);
+    return pid;
+}
+
+/** Starts a program, searched in PATH, with its standard input and output
+ * connected to a Unix socket. The standard error is inherited.
+ * @param args program name and arguments
+ * @param connection output parent end of the socket (close it to send end of file)
+ * @return the child process id
+*/
+pid_t spawnConnected(const std::vector<std::string>& args, int& connection) {
+    int ends[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, ends) != 0)
+        throw std::runtime_error("Cannot start " + args[0]);
+
+    std::vector<char*> argv;
+    for (const std::string& a : args)
+        argv.push_back(const_cast<char*>(a.c_str()));
+    argv.push_back(nullptr);
+
+    // the duplicated descriptors do not inherit close-on-exec
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, ends[1], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, ends[1], STDOUT_FILENO);
+    pid_t pid;
+    const int result = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(ends[1]);
+    if (result != 0) {
+        close(ends[0]);
+        throw std::runtime_error("Cannot start " + args[0]);
+    }
+    connection = ends[0];
+    return pid;
+}
+
+/** Checks whether a child process has exited, without blocking.
+ * An exited child is reaped: do not poll it again.
+ * @param pid child process id
+ * @param status output exit code (-1 if the child was killed by a signal or cannot be waited)
+ * @return true if the child has exited
+*/
+bool exited(pid_t pid, int& status) {
+    int raw;
+    const pid_t result = waitpid(pid, &raw, WNOHANG);
+    if (result == 0)
+        return false;
+    status = ((result == pid) && WIFEXITED(raw)) ? WEXITSTATUS(raw) : -1;
+    return true;
+}
+
+/** Kills a running child process and reaps it.
+ * @param pid child process id
+*/
+void terminate(pid_t pid) {
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+}
+
+/** Owner of child processes and temporary files.
+ * The destructor kills the children still running and removes the files,
+ * also when the owner leaves its scope because of an exception.
+*/
+class ChildGroup {
+public:
+    ChildGroup() = default;
+    ChildGroup(const ChildGroup&) = delete;
+    ChildGroup& operator=(const ChildGroup&) = delete;
+
+    ~ChildGroup() {
+        for (pid_t pid : children)
+            if (pid != -1)
+                terminate(pid);
+        for (const std::string& file : files)
+            std::remove(file.c_str());
+    }
+
+    /** Creates a temporary file (see ProcessUtils::temporaryFile), removed with the group.
+     * @param prefix file name prefix
+     * @return the file path
+    */
+    std::string temporaryFile(const std::string& prefix) {
+        files.reserve(files.size() + 1);    // no throw once the file exists
+        files.push_back(ProcessUtils::temporaryFile(prefix));
+        return files.back();
+    }
+
+    /** Starts a child (see ProcessUtils::spawn), killed with the group if still running.
+     * @param args program name and arguments
+     * @return index of the child in the group
+    */
+    size_t spawn(const std::vector<std::string>& args) {
+        children.reserve(children.size() + 1);  // no throw once the child runs
+        children.push_back(ProcessUtils::spawn(args));
+        return children.size() - 1;
+    }
+
+    /** Checks whether a child has exited, without blocking (see ProcessUtils::exited).
+     * @param i index of the child
+     * @param status output exit code, only the first time true is returned
+     * @return true if the child has exited
+    */
+    bool exited(size_t i, int& status) {
+        if (children[i] == -1)
+            return true;
+        if (!ProcessUtils::exited(children[i], status))
+            return false;
+        children[i] = -1;   // reaped
+        return true;
+    }
+
+    /** @param i index of the child
+     * @return true if the child was not seen exiting yet */
+    bool running(size_t i) const { return children[i] != -1; }
+
+    size_t size() const { return children.size(); }    ///< Number of children.
+
+private:
+    std::vector<pid_t> children;    ///< Children still running (-1 once reaped).
+    std::vector<std::string> files; ///< Temporary files.
+};
+
+}   // namespace ProcessUtils
@@ -0,0 +1,243 @@
+/** \file rectification.hpp
+ * @brief Precomputed undistortion and plane rectification tables.
+ *
+ * cv::undistort rebuilds its undistortion maps at every call and unwarping the
+ * undistorted frame resamples it a second time. Since camera matrix,
+ * distortion coefficients and plane transform do not change after the
+ * calibration, the two transforms are composed once into a single fixed-point
+ * remap table (CV_16SC2 coordinates + CV_16UC1 interpolation table): the
+ * unwarped image is then resampled once, from the raw frame.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "opencv2/imgproc.hpp"
+#include "opencv2/calib3d.hpp"
+#include <stdexcept>
+
+//! Rectification (undistortion + unwarping) utilities
+namespace Rectification {
+
+/** Checks whether two matrices hold exactly the same values.
+ * @param a first matrix
+ * @param b second matrix
+ * @return true if size, type and values are the same
+*/
+bool sameMatrix(const cv::Mat& a, const cv::Mat& b) {
+    if (a.empty() || b.empty())
+        return a.empty() && b.empty();
+    if ((a.size() != b.size()) || (a.type() != b.type()))
+        return false;
+    return cv::norm(a, b, cv::NORM_INF) == 0;
+}
+
+/** Fixed-point remap table. */
+struct RemapTable {
+    cv::Mat map1;   ///< Integer source coordinates (CV_16SC2).
+    cv::Mat map2;   ///< Interpolation table (CV_16UC1).
+
+    /** @return true if the table was not built yet. */
+    bool empty() const { return map1.empty(); }
+};
+
+/** Builds the undistortion table.
+ * Equivalent to the maps built internally by cv::undistort.
+ * @param cam_matrix camera matrix
+ * @param dist_coeffs distortion coefficients
+ * @param size image size
+ * @param table output remap table
+*/
+void buildUndistortTable(const cv::Mat& cam_matrix, const cv::Mat& dist_coeffs,
+                         const cv::Size& size, RemapTable& table) {
+    cv::initUndistortRectifyMap(cam_matrix, dist_coeffs, cv::Mat(), cam_matrix,
+                                size, CV_16SC2, table.map1, table.map2);
+}
+
+/** Builds the fused undistortion + plane transform table.
+ * Every output pixel p is mapped to the undistorted pixel H^-1 * p and then
+ * through the lens distortion model to the raw frame.
+ * initUndistortRectifyMap back-projects every output pixel with
+ * (newCameraMatrix * R)^-1 before distorting it, so passing H * K as new
+ * camera matrix composes the two transforms exactly.
+ * @param cam_matrix camera matrix K
+ * @param dist_coeffs distortion coefficients
+ * @param plane_transf plane perspective transform H (undistorted -> unwarped)
+ * @param size image size
+ * @param table output remap table
+*/
+void buildFusedTable(const cv::Mat& cam_matrix, const cv::Mat& dist_coeffs,
+                     const cv::Mat& plane_transf, const cv::Size& size,
+                     RemapTable& table) {
+    cv::Mat K, H;
+    cam_matrix.convertTo(K, CV_64F);
+    plane_transf.convertTo(H, CV_64F);
+    cv::Mat HK = H * K;
+    cv::initUndistortRectifyMap(K, dist_coeffs, cv::Mat(), HK, size, CV_16SC2,
+                                table.map1, table.map2);
+}
+
+/** Cache of the rectification tables.
+ * Tables are rebuilt only when the calibration parameters or the image size
+ * change.
+*/
+class RemapCache {
+public:
+    /** Undistorts an image with the cached undistortion table.
+     * @param img_in distorted input image
+     * @param img_out undistorted output image
+     * @param cam_matrix camera matrix
+     * @param dist_coeffs distortion coefficients
+    */
+    void undistort(const cv::Mat& img_in, cv::Mat& img_out,
+                   const cv::Mat& cam_matrix, const cv::Mat& dist_coeffs) {
+        setIntrinsics(cam_matrix, dist_coeffs);
+        if (undistortTable.empty() || (undistortSize != img_in.size())) {
+            buildUndistortTable(cam, dist, img_in.size(), undistortTable);
+            undistortSize = img_in.size();
+        }
+        cv::remap(img_in, img_out, undistortTable.map1, undistortTable.map2,
+                  cv::INTER_LINEAR);
+    }
+
+    /** Undistorts and unwarps a raw frame with a single remap pass.
+     * Intrinsics must have been set before (see setIntrinsics).
+     * @param img_in raw (distorted) input image
+     * @param img_out rectified output image
+     * @param plane_transf plane perspective transform
+    */
+    void rectify(const cv::Mat& img_in, cv::Mat& img_out,
+                 const cv::Mat& plane_transf) {
+        if (cam.empty())
+            throw std::logic_error("Rectification: intrinsics are not set");
+        if (fusedTable.empty() || (fusedSize != img_in.size()) ||
+            !sameMatrix(plane, plane_transf)) {
+            plane = plane_transf.clone();
+            buildFusedTable(cam, dist, plane, img_in.size(), fusedTable);
+            fusedSize = img_in.size();
+        }
+        cv::remap(img_in, img_out, fusedTable.map1, fusedTable.map2,
+                  cv::INTER_LINEAR);
+    }
+
+    /** Stores the camera parameters, invalidating tables if they changed.
+     * @param cam_matrix camera matrix
+     * @param dist_coeffs distortion coefficients
+    */
+    void setIntrinsics(const cv::Mat& cam_matrix, const cv::Mat& dist_coeffs) {
+        if (sameMatrix(cam, cam_matrix) && sameMatrix(dist, dist_coeffs))
+            return;
+        cam = cam_matrix.clone();
+        dist = dist_coeffs.clone();
+        undistortTable = RemapTable();
+        fusedTable = RemapTable();
+    }
+
+    /** Stores the plane transform, enabling the fused path.
+     * @param plane_transf plane perspective transform
+    */
+    void setPlaneTransform(const cv::Mat& plane_transf) {
+        if (!sameMatrix(plane, plane_transf)) {
+            plane = plane_transf.clone();
+            fusedTable = RemapTable();
+        }
+    }
+
+    /** Builds the fused table in advance (e.g. to store it).
+     * @param size image size
+     * @return the fused table
+    */
+    const RemapTable& fused(const cv::Size& size) {
+        if (!canFuse())
+            throw std::logic_error("Rectification: calibration is not complete");
+        if (fusedTable.empty() || (fusedSize != size)) {
+            buildFusedTable(cam, dist, plane, size, fusedTable);
+            fusedSize = size;
+        }
+        return fusedTable;
+    }
+
+    /** Installs a previously built fused table.
+     * It must have been built with the current intrinsics and plane transform.
+     * @param table fused table
+     * @param size image size of the table
+    */
+    void setFused(const RemapTable& table, const cv::Size& size) {
+        fusedTable = table;
+        fusedSize = size;
+    }
+
+    /** @return true if intrinsics and plane transform are both known. */
+    bool canFuse() const { return !cam.empty() && !plane.empty(); }
+
+    /** Remembers the raw frame an undistorted image was computed from.
+     * Both images are referenced, so their buffers stay allocated and cannot
+     * be handed to another image while they are remembered.
+     * @param raw raw frame
+     * @param undistorted undistorted image of raw
+    */
+    void setSource(const cv::Mat& raw, const cv::Mat& undistorted) {
+        sourceRaw = raw;
+        sourceUndistorted = undistorted;
+        sourcePending = false;
+    }
+
+    /** Remembers a raw frame without undistorting it yet (see fill).
+     * Once the fused table is in use, rectified images are resampled from the
+     * raw frame only, so the undistortion is skipped until the undistorted
+     * image itself is read. Its buffer is allocated (or shared with the raw
+     * frame when undistorting in place) to identify it in sourceOf.
+     * @param raw raw frame
+     * @param undistorted image standing for the undistorted raw frame
+    */
+    void deferUndistort(const cv::Mat& raw, cv::Mat& undistorted) {
+        if (undistorted.data != raw.data)
+            undistorted.create(raw.size(), raw.type());
+        sourceRaw = raw;
+        sourceUndistorted = undistorted;
+        sourcePending = true;
+    }
+
+    /** Undistorts an image remembered by deferUndistort, if not done yet.
+     * Any other image is left untouched.
+     * @param img image about to be read
+    */
+    void fill(const cv::Mat& img) {
+        if (!sourcePending || sourceOf(img).empty())
+            return;
+        if (sourceRaw.data == sourceUndistorted.data)
+            sourceRaw = sourceRaw.clone();  // in place: keep the raw frame for rectify
+        cv::Mat out = sourceUndistorted;    // same buffer as img
+        undistort(sourceRaw, out, cam, dist);
+        sourcePending = false;
+    }
+
+    /** Finds the raw frame of the last image remembered by setSource.
+     * @param img image to check
+     * @return the raw frame of img, empty if img is not the remembered image
+    */
+    cv::Mat sourceOf(const cv::Mat& img) const {
+        if (sourceUndistorted.empty() || (img.u != sourceUndistorted.u) ||
+            (img.data != sourceUndistorted.data) || (img.size() != sourceUndistorted.size()))
+            return cv::Mat();
+        return sourceRaw;
+    }
+
+    const cv::Mat& cameraMatrix() const { return cam; }      ///< Cached camera matrix.
+    const cv::Mat& distCoeffs() const { return dist; }       ///< Cached distortion coefficients.
+    const cv::Mat& planeTransform() const { return plane; }  ///< Cached plane transform.
+
+private:
+    cv::Mat cam;                ///< Camera matrix.
+    cv::Mat dist;               ///< Distortion coefficients.
+    cv::Mat plane;              ///< Plane perspective transform.
+    RemapTable undistortTable;  ///< Undistortion only table.
+    cv::Size undistortSize;     ///< Image size of undistortTable.
+    RemapTable fusedTable;      ///< Undistortion + plane transform table.
+    cv::Size fusedSize;         ///< Image size of fusedTable.
+    cv::Mat sourceRaw;          ///< Raw frame of sourceUndistorted.
+    cv::Mat sourceUndistorted;  ///< Last undistorted image (see setSource).
+    bool sourcePending = false; ///< sourceUndistorted is not filled yet (see deferUndistort).
+};
+
+}   // namespace Rectification
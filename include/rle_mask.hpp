@@ -0,0 +1,363 @@
+/** \file rle_mask.hpp
+ * @brief Run-length encoded binary masks.
+ *
+ * Arena masks are very sparse (a few blobs on a large frame), so storing
+ * them as horizontal runs of set pixels makes thresholding, union, dilation
+ * and blob extraction scale with the blobs instead of the frame: the frame is
+ * read once by the threshold, union and labeling only touch runs, and
+ * dilation (Morphology) and contour tracing run on a raster of each blob
+ * bounding box only.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "morphology.hpp"
+#include "opencv2/imgproc.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+//! Run-length encoded mask utilities
+namespace RLE {
+
+/** Horizontal run of set pixels. */
+struct Run {
+    int row;    ///< Row of the run.
+    int start;  ///< First pixel of the run.
+    int end;    ///< One past the last pixel of the run.
+};
+
+/** Run-length encoded binary mask.
+ * Runs are sorted by row and start and never overlap or touch.
+*/
+struct Mask {
+    cv::Size size;          ///< Mask size.
+    std::vector<Run> runs;  ///< Runs of set pixels.
+
+    /** @return number of set pixels. */
+    int area() const {
+        int a = 0;
+        for (const Run& r : runs)
+            a += r.end - r.start;
+        return a;
+    }
+
+    /** Paints the runs inside an area into an 8-bit raster.
+     * @param area region to rasterize
+     * @param out output mask of the area size (255 where set)
+    */
+    void rasterize(const cv::Rect& area, cv::Mat& out) const {
+        out = cv::Mat::zeros(area.size(), CV_8UC1);
+        auto first = std::lower_bound(runs.begin(), runs.end(), area.y,
+                                      [](const Run& r, int row) { return r.row < row; });
+        for (auto it = first; (it != runs.end()) && (it->row < area.br().y); ++it) {
+            const int s = std::max(it->start, area.x);
+            const int e = std::min(it->end, area.br().x);
+            if (s < e)
+                std::fill(out.ptr<uchar>(it->row - area.y) + (s - area.x),
+                          out.ptr<uchar>(it->row - area.y) + (e - area.x), 255);
+        }
+    }
+};
+
+/** Connected component (8-connectivity) of a mask. */
+struct Component {
+    cv::Rect bbox;                      ///< Bounding box.
+    int area;                           ///< Number of pixels.
+    std::vector<cv::Point> contour;     ///< External contour (as cv::findContours).
+};
+
+/** Sorts runs by row and start and merges overlapping or touching ones.
+ * @param runs runs to normalize (modified in place)
+*/
+void normalize(std::vector<Run>& runs) {
+    std::sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) {
+        return (a.row < b.row) || ((a.row == b.row) && (a.start < b.start));
+    });
+    size_t n = 0;
+    for (size_t i = 0; i < runs.size(); ++i) {
+        if ((n > 0) && (runs[n-1].row == runs[i].row) && (runs[i].start <= runs[n-1].end))
+            runs[n-1].end = std::max(runs[n-1].end, runs[i].end);
+        else
+            runs[n++] = runs[i];
+    }
+    runs.resize(n);
+}
+
+/** Thresholds an 8-bit 3 channel image straight into runs.
+ * Same bounds semantics as cv::inRange (inclusive).
+ * @param img input image
+ * @param low lower bounds
+ * @param high upper bounds
+ * @return mask of the pixels inside the bounds
+*/
+Mask threshold(const cv::Mat& img, const cv::Scalar& low, const cv::Scalar& high) {
+    if (img.type() != CV_8UC3)
+        throw std::invalid_argument("RLE: 8-bit 3 channel image expected");
+    uchar lo[3], hi[3];
+    for (int c = 0; c < 3; ++c) {
+        lo[c] = cv::saturate_cast<uchar>(std::ceil(low[c]));
+        hi[c] = cv::saturate_cast<uchar>(std::floor(high[c]));
+    }
+
+    Mask mask;
+    mask.size = img.size();
+    for (int y = 0; y < img.rows; ++y) {
+        const uchar* px = img.ptr<uchar>(y);
+        int start = -1;
+        for (int x = 0; x < img.cols; ++x, px += 3) {
+            const bool in = (px[0] >= lo[0]) && (px[0] <= hi[0]) &&
+                            (px[1] >= lo[1]) && (px[1] <= hi[1]) &&
+                            (px[2] >= lo[2]) && (px[2] <= hi[2]);
+            if (in && (start < 0)) {
+                start = x;
+            } else if (!in && (start >= 0)) {
+                mask.runs.push_back({y, start, x});
+                start = -1;
+            }
+        }
+        if (start >= 0)
+            mask.runs.push_back({y, start, img.cols});
+    }
+    return mask;
+}
+
+/** Union of two masks of the same size.
+ * @param a first mask
+ * @param b second mask
+ * @return pixels set in a or b
+*/
+Mask unite(const Mask& a, const Mask& b) {
+    if (a.size != b.size)
+        throw std::invalid_argument("RLE: mask sizes differ");
+    Mask u;
+    u.size = a.size;
+    u.runs.reserve(a.runs.size() + b.runs.size());
+    std::merge(a.runs.begin(), a.runs.end(), b.runs.begin(), b.runs.end(),
+               std::back_inserter(u.runs), [](const Run& l, const Run& r) {
+        return (l.row < r.row) || ((l.row == r.row) && (l.start < r.start));
+    });
+    normalize(u.runs);
+    return u;
+}
+
+/** Appends the runs of an 8-bit binary raster.
+ * @param binary raster (non zero pixels are set)
+ * @param offset offset added to the runs
+ * @param runs output runs, appended in row order
+*/
+void appendRuns(const cv::Mat& binary, const cv::Point& offset, std::vector<Run>& runs) {
+    for (int y = 0; y < binary.rows; ++y) {
+        const uchar* px = binary.ptr<uchar>(y);
+        int start = -1;
+        for (int x = 0; x < binary.cols; ++x) {
+            if ((px[x] != 0) && (start < 0)) {
+                start = x;
+            } else if ((px[x] == 0) && (start >= 0)) {
+                runs.push_back({y + offset.y, start + offset.x, x + offset.x});
+                start = -1;
+            }
+        }
+        if (start >= 0)
+            runs.push_back({y + offset.y, start + offset.x, binary.cols + offset.x});
+    }
+}
+
+/** Encodes an 8-bit binary image.
+ * @param binary input image (non zero pixels are set)
+ * @return the mask
+*/
+Mask encode(const cv::Mat& binary) {
+    if (binary.type() != CV_8UC1)
+        throw std::invalid_argument("RLE: 8-bit single channel image expected");
+    Mask mask;
+    mask.size = binary.size();
+    appendRuns(binary, cv::Point(), mask.runs);
+    return mask;
+}
+
+/** Labels the connected components (8-connectivity) of a set of runs.
+ * Union-find over the runs of consecutive rows.
+ * @param runs runs of a mask
+ * @param count output number of components
+ * @return component of every run, numbered in the order of their first run
+*/
+std::vector<int> labelRuns(const std::vector<Run>& runs, int& count) {
+    std::vector<int> parent(runs.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&](int i) {
+        while (parent[i] != i)
+            i = parent[i] = parent[parent[i]];
+        return i;
+    };
+
+    // runs of the previous row touching a run (diagonals included)
+    size_t prevBegin = 0, prevEnd = 0;
+    for (size_t i = 0; i < runs.size(); ) {
+        size_t rowEnd = i;
+        while ((rowEnd < runs.size()) && (runs[rowEnd].row == runs[i].row))
+            ++rowEnd;
+        const bool adjacent = (prevEnd > prevBegin) && (runs[prevBegin].row == runs[i].row - 1);
+        if (adjacent) {
+            size_t p = prevBegin;
+            for (size_t j = i; j < rowEnd; ++j) {
+                while ((p < prevEnd) && (runs[p].end < runs[j].start))
+                    ++p;
+                for (size_t q = p; (q < prevEnd) && (runs[q].start <= runs[j].end); ++q) {
+                    const int a = find(j), b = find(q);
+                    if (a != b)
+                        parent[std::max(a, b)] = std::min(a, b);
+                }
+            }
+        }
+        prevBegin = i;
+        prevEnd = rowEnd;
+        i = rowEnd;
+    }
+
+    std::vector<int> label(runs.size(), -1);
+    count = 0;
+    for (size_t i = 0; i < runs.size(); ++i) {
+        const int root = find(i);
+        if (label[root] < 0)
+            label[root] = count++;
+        label[i] = label[root];
+    }
+    return label;
+}
+
+/** Dilation of the blobs of a mask on rasters of their bounding boxes.
+ * Dilation distributes over union, so every group of blobs whose padded
+ * bounding boxes overlap is rasterized, dilated with the constant cost per
+ * pixel methods of Morphology and encoded again. The cost grows with the
+ * padded boxes, not with the number of runs times the kernel height.
+ * @param mask input mask
+ * @param pad padding of the boxes (at least the reach of the kernel)
+ * @param dilation dilation of a raster, as dilation(src, dst)
+ * @return dilated mask
+*/
+template <typename Dilation>
+Mask dilateBlobs(const Mask& mask, int pad, Dilation dilation) {
+    int count;
+    const std::vector<int> label = labelRuns(mask.runs, count);
+    std::vector<cv::Rect> areas(count);
+    for (size_t i = 0; i < mask.runs.size(); ++i) {
+        const Run& r = mask.runs[i];
+        const cv::Rect run(r.start, r.row, r.end - r.start, 1);
+        areas[label[i]] = (areas[label[i]].area() == 0) ? run : (areas[label[i]] | run);
+    }
+    const cv::Rect frame(cv::Point(), mask.size);
+    for (cv::Rect& area : areas)
+        area = cv::Rect(area.x - pad, area.y - pad, area.width + 2 * pad, area.height + 2 * pad) & frame;
+
+    // merge the overlapping areas, so no pixel is dilated twice
+    for (bool merged = true; merged; ) {
+        merged = false;
+        for (size_t i = 0; i < areas.size(); ++i)
+            for (size_t j = i + 1; j < areas.size(); ) {
+                if ((areas[i] & areas[j]).area() > 0) {
+                    areas[i] |= areas[j];
+                    areas.erase(areas.begin() + j);
+                    merged = true;
+                } else {
+                    ++j;
+                }
+            }
+    }
+
+    Mask out;
+    out.size = mask.size;
+    cv::Mat raster, dilated;
+    for (const cv::Rect& area : areas) {
+        mask.rasterize(area, raster);
+        dilation(raster, dilated);
+        appendRuns(dilated, area.tl(), out.runs);
+    }
+    normalize(out.runs);
+    return out;
+}
+
+/** Dilation with a rectangular structuring element.
+ * Same result as cv::dilate with a MORPH_RECT kernel of the given size,
+ * default anchor (center) and border.
+ * @param mask input mask
+ * @param size kernel size
+ * @return dilated mask
+*/
+Mask dilateRect(const Mask& mask, const cv::Size& size) {
+    return dilateBlobs(mask, std::max(size.width, size.height), [&size](const cv::Mat& src, cv::Mat& dst) {
+        Morphology::dilateRect(src, dst, size);
+    });
+}
+
+/** Dilation with a disk structuring element.
+ * Same result as thresholding the euclidean distance from the set pixels at
+ * radius (see Morphology::dilateDisk).
+ * @param mask input mask
+ * @param radius disk radius in pixels
+ * @return dilated mask
+*/
+Mask dilateDisk(const Mask& mask, float radius) {
+    return dilateBlobs(mask, static_cast<int>(std::ceil(radius)) + 1, [radius](const cv::Mat& src, cv::Mat& dst) {
+        Morphology::dilateDisk(src, dst, radius);
+    });
+}
+
+/** Binary dilation with a constant cost per pixel of the blob boxes.
+ * @param mask input mask
+ * @param shape structuring element shape
+ * @param size structuring element width (side of the square, diameter of the disk)
+ * @return dilated mask
+*/
+Mask dilate(const Mask& mask, Morphology::Footprint shape, int size) {
+    if (shape == Morphology::Footprint::rect)
+        return dilateRect(mask, cv::Size(size, size));
+    return dilateDisk(mask, size / 2.0f);
+}
+
+/** Finds the connected components (8-connectivity) of a mask.
+ * Runs are labeled with labelRuns, then the contour of every component is
+ * traced on a raster of its bounding box.
+ * @param mask input mask
+ * @param offset offset added to the bounding boxes and contour points
+ * @return components, in the order of their first run
+*/
+std::vector<Component> components(const Mask& mask, const cv::Point& offset = cv::Point()) {
+    const std::vector<Run>& runs = mask.runs;
+    int count;
+    const std::vector<int> label = labelRuns(runs, count);
+
+    std::vector<Component> comps(count);
+    std::vector<std::vector<size_t>> members(count);
+    for (size_t i = 0; i < runs.size(); ++i) {
+        Component& c = comps[label[i]];
+        const cv::Rect run(runs[i].start, runs[i].row, runs[i].end - runs[i].start, 1);
+        c.bbox = members[label[i]].empty() ? run : (c.bbox | run);
+        c.area += runs[i].end - runs[i].start;
+        members[label[i]].push_back(i);
+    }
+
+    cv::Mat raster;
+    std::vector<std::vector<cv::Point>> contours;
+    for (size_t k = 0; k < comps.size(); ++k) {
+        Component& c = comps[k];
+        // one pixel of zero border, as the blob is surrounded by background
+        raster = cv::Mat::zeros(c.bbox.height + 2, c.bbox.width + 2, CV_8UC1);
+        for (size_t i : members[k]) {
+            uchar* row = raster.ptr<uchar>(runs[i].row - c.bbox.y + 1);
+            std::fill(row + runs[i].start - c.bbox.x + 1, row + runs[i].end - c.bbox.x + 1, 255);
+        }
+        cv::findContours(raster, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE,
+                         c.bbox.tl() - cv::Point(1, 1) + offset);
+        if (!contours.empty())
+            c.contour = contours[0];
+        c.bbox += offset;
+    }
+    return comps;
+}
+
+}   // namespace RLE
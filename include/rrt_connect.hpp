@@ -0,0 +1,164 @@
+/** \file rrt_connect.hpp
+ * @brief Bidirectional RRT-Connect point planner.
+ *
+ * Two trees grow from the start and from the goal. Every iteration extends
+ * one tree by a step towards a random sample, then the other tree greedily
+ * steps towards the new node until it reaches it or hits an obstacle; the
+ * trees swap roles every iteration. The greedy connection crosses narrow
+ * passages between inflated obstacles much sooner than a single tree with
+ * goal bias (src/planner_bench.cpp compares it with rrt.py).
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "collision_checker.hpp"
+#include "point_planner.hpp"
+#include "spatial_grid.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+//! Point path planning
+namespace Planning {
+
+/** RRT-Connect planner. */
+class RRTConnect : public PointPlanner {
+public:
+    /** Planner parameters. */
+    struct Parameters {
+        float step = 0.05f;             ///< Maximum edge length (m).
+        size_t maxIterations = 20000;   ///< Iteration limit of a query.
+        uint32_t seed = 1;              ///< Random seed.
+    };
+
+    /** Creates the planner.
+     * @param checker collision checker of the arena
+     * @param parameters planner parameters
+    */
+    RRTConnect(const CollisionChecker& checker, const Parameters& parameters)
+        : checker(checker), parameters(parameters), rng(parameters.seed) {}
+
+    std::vector<Point> plan(const Point& start, const Point& goal) override {
+        iterations = 0;
+        if (checker.segmentFreeFrom(start, goal) && checker.segmentFreeFrom(goal, start))
+            return {start, goal};
+
+        Tree trees[2] = { Tree(checker, start), Tree(checker, goal) };
+        std::uniform_real_distribution<float> x(checker.minXBound(), checker.maxXBound());
+        std::uniform_real_distribution<float> y(checker.minYBound(), checker.maxYBound());
+
+        int a = 0;  // tree extended towards the sample
+        for (; iterations < parameters.maxIterations; ++iterations, a = 1 - a) {
+            const Point sample(x(rng), y(rng));
+            const int added = extend(trees[a], sample);
+            if (added == -1)
+                continue;
+
+            const Point& target = trees[a].grid.point(added);
+            const int reached = connect(trees[1 - a], target);
+            if (reached == -1)
+                continue;
+
+            // join the two branches at target
+            std::vector<Point> path = trees[a].branch(added);
+            std::vector<Point> other = trees[1 - a].branch(reached);
+            std::reverse(path.begin(), path.end());
+            path.insert(path.end(), other.begin() + 1, other.end());
+            if (a == 1)
+                std::reverse(path.begin(), path.end());  // path started from the goal
+            ++iterations;
+            return path;
+        }
+        throw std::runtime_error("Path not found!");
+    }
+
+    std::string name() const override { return "RRT-Connect"; }
+
+    size_t lastIterations() const override { return iterations; }
+
+private:
+    /** Search tree rooted at a query point. */
+    struct Tree {
+        PointGrid grid;             ///< Node points and their index.
+        std::vector<int> parent;    ///< Parent of every node (-1 for the root).
+
+        Tree(const CollisionChecker& checker, const Point& root)
+            : grid(checker.minXBound(), checker.minYBound(), checker.maxXBound(), checker.maxYBound(), GRID_CELL) {
+            grid.insert(root);
+            parent.push_back(-1);
+        }
+
+        /** Adds a node.
+         * @return the node index
+        */
+        int add(const Point& p, int from) {
+            parent.push_back(from);
+            return grid.insert(p);
+        }
+
+        /** @return the points from a node back to the root */
+        std::vector<Point> branch(int n) const {
+            std::vector<Point> points;
+            for (; n != -1; n = parent[n])
+                points.push_back(grid.point(n));
+            return points;
+        }
+    };
+
+    /** Extends a tree by one step towards a point.
+     * @param tree tree
+     * @param target point to move towards
+     * @return the new node, -1 if the step collides
+    */
+    int extend(Tree& tree, const Point& target) const {
+        const int nearest = tree.grid.nearest(target);
+        return stepFrom(tree, nearest, target);
+    }
+
+    /** Extends a tree towards a point until it reaches it or collides.
+     * @param tree tree
+     * @param target point to reach
+     * @return the node at target, -1 if it was not reached
+    */
+    int connect(Tree& tree, const Point& target) const {
+        int node = tree.grid.nearest(target);
+        while (distance(tree.grid.point(node), target) > 0) {
+            node = stepFrom(tree, node, target);
+            if (node == -1)
+                return -1;
+        }
+        return node;
+    }
+
+    /** Adds a node one step from a tree node towards a point.
+     * @param tree tree
+     * @param from tree node
+     * @param target point to move towards
+     * @return the new node, -1 if the step collides
+    */
+    int stepFrom(Tree& tree, int from, const Point& target) const {
+        const Point& p = tree.grid.point(from);
+        const float d = distance(p, target);
+        const Point q = (d <= parameters.step) ? target
+                      : Point(p.x + (target.x - p.x) * parameters.step / d,
+                              p.y + (target.y - p.y) * parameters.step / d);
+        if (!checker.pointFree(q))
+            return -1;
+        // contacts at the roots (query points) are ignored
+        const bool free = (from == 0) ? checker.segmentFreeFrom(p, q) : checker.segmentFree(p, q);
+        return free ? tree.add(q, from) : -1;
+    }
+
+    static constexpr float GRID_CELL = 0.05f;   ///< Neighbour index cell (m).
+
+    const CollisionChecker checker;     ///< Arena collision checker.
+    const Parameters parameters;        ///< Planner parameters.
+    std::mt19937 rng;                   ///< Sampling generator (kept across queries).
+    size_t iterations = 0;              ///< Iterations of the last query.
+};
+
+}   // namespace Planning
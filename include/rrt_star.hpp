@@ -0,0 +1,219 @@
+/** \file rrt_star.hpp
+ * @brief Anytime informed RRT* point planner.
+ *
+ * RRT* rewires the tree around every new node, so the path keeps improving
+ * while the tree grows. Once a path is found, samples are drawn only inside
+ * the ellipse of the points that could still shorten it (informed RRT*).
+ * The search runs for a wall-clock budget and returns the best path found;
+ * if no path was found when the budget expires it goes on until the first
+ * one (or the iteration limit).
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "collision_checker.hpp"
+#include "point_planner.hpp"
+#include "spatial_grid.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+//! Point path planning
+namespace Planning {
+
+/** Anytime informed RRT* planner. */
+class InformedRRTStar : public PointPlanner {
+public:
+    /** Planner parameters. */
+    struct Parameters {
+        double budget = 0.05;               ///< Planning time of a query (s).
+        float step = 0.1f;                  ///< Maximum edge length (m).
+        double goalBias = 0.05;             ///< Probability of sampling the goal before the first path.
+        size_t maxIterations = 200000;      ///< Iteration limit of a query.
+        uint32_t seed = 1;                  ///< Random seed.
+    };
+
+    /** Creates the planner.
+     * @param checker collision checker of the arena
+     * @param parameters planner parameters
+    */
+    InformedRRTStar(const CollisionChecker& checker, const Parameters& parameters)
+        : checker(checker), parameters(parameters), rng(parameters.seed) {
+        // rewiring constant for a 2D free space as large as the borders box
+        const double area = (checker.maxXBound() - checker.minXBound()) * (checker.maxYBound() - checker.minYBound());
+        gamma = 2 * std::sqrt(1.5) * std::sqrt(area / M_PI);
+    }
+
+    std::vector<Point> plan(const Point& start, const Point& goal) override {
+        iterations = 0;
+        if (checker.segmentFreeFrom(start, goal) && checker.segmentFreeFrom(goal, start))
+            return {start, goal};
+
+        const auto deadline = std::chrono::steady_clock::now() +
+                              std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                  std::chrono::duration<double>(parameters.budget));
+        Tree tree(checker);
+        tree.add(start, -1, 0);
+
+        std::uniform_real_distribution<float> unit(0, 1);
+        std::uniform_real_distribution<float> x(checker.minXBound(), checker.maxXBound());
+        std::uniform_real_distribution<float> y(checker.minYBound(), checker.maxYBound());
+
+        const float cMin = distance(start, goal);
+        const Point center((start.x + goal.x) / 2, (start.y + goal.y) / 2);
+        const float angle = std::atan2(goal.y - start.y, goal.x - start.x);
+
+        std::vector<int> atGoal;    // nodes linked to the goal
+        int best = -1;
+        double bestCost = std::numeric_limits<double>::infinity();
+
+        for (iterations = 0; iterations < parameters.maxIterations; ++iterations) {
+            if ((best != -1) && (std::chrono::steady_clock::now() >= deadline))
+                break;
+
+            // sample: goal, informed ellipse or borders box
+            Point sample;
+            if (best != -1) {
+                const float a = bestCost / 2;
+                const float b = std::sqrt(std::max(0.0, bestCost * bestCost - cMin * cMin)) / 2;
+                const float r = std::sqrt(unit(rng)), t = 2 * M_PI * unit(rng);
+                const float ex = a * r * std::cos(t), ey = b * r * std::sin(t);
+                sample = Point(center.x + ex * std::cos(angle) - ey * std::sin(angle),
+                               center.y + ex * std::sin(angle) + ey * std::cos(angle));
+            } else if (unit(rng) < parameters.goalBias) {
+                sample = goal;
+            } else {
+                sample = Point(x(rng), y(rng));
+            }
+
+            // steer from the nearest node
+            const int nearest = tree.grid.nearest(sample);
+            const Point& from = tree.grid.point(nearest);
+            const float d = distance(from, sample);
+            if (d == 0)
+                continue;
+            const float f = std::min(1.f, parameters.step / d);
+            const Point p(from.x + (sample.x - from.x) * f, from.y + (sample.y - from.y) * f);
+            if (!checker.pointFree(p) || !edgeFree(tree, nearest, p))
+                continue;
+
+            // cheapest parent among the near nodes
+            const size_t n = tree.grid.size() + 1;
+            const float radius = std::min<double>(parameters.step, gamma * std::sqrt(std::log(n) / n));
+            std::vector<int> near = tree.grid.withinRadius(p, radius);
+            int parent = nearest;
+            double cost = tree.cost[nearest] + distance(from, p);
+            for (int q : near) {
+                const double c = tree.cost[q] + distance(tree.grid.point(q), p);
+                if ((c < cost) && edgeFree(tree, q, p)) {
+                    parent = q;
+                    cost = c;
+                }
+            }
+            const int id = tree.add(p, parent, cost);
+
+            // rewire the near nodes through the new one
+            for (int q : near) {
+                const double c = cost + distance(p, tree.grid.point(q));
+                if ((q != parent) && (c < tree.cost[q]) && edgeFree(tree, q, p))
+                    tree.reparent(q, id, c);
+            }
+
+            if ((distance(p, goal) <= parameters.step) && checker.segmentFreeFrom(goal, p))
+                atGoal.push_back(id);
+            for (int g : atGoal) {
+                const double c = tree.cost[g] + distance(tree.grid.point(g), goal);
+                if (c < bestCost) {
+                    best = g;
+                    bestCost = c;
+                }
+            }
+        }
+
+        if (best == -1)
+            throw std::runtime_error("Path not found!");
+
+        std::vector<Point> path = {goal};
+        for (int n = best; n != -1; n = tree.parent[n])
+            path.push_back(tree.grid.point(n));
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    std::string name() const override { return "informed RRT*"; }
+
+    size_t lastIterations() const override { return iterations; }
+
+private:
+    /** Search tree. */
+    struct Tree {
+        PointGrid grid;                         ///< Node points and their index.
+        std::vector<int> parent;                ///< Parent of every node (-1 for the root).
+        std::vector<double> cost;               ///< Path length from the root.
+        std::vector<std::vector<int>> children; ///< Children of every node.
+
+        explicit Tree(const CollisionChecker& checker)
+            : grid(checker.minXBound(), checker.minYBound(), checker.maxXBound(), checker.maxYBound(), GRID_CELL) {}
+
+        /** Adds a node.
+         * @return the node index
+        */
+        int add(const Point& p, int from, double c) {
+            const int id = grid.insert(p);
+            parent.push_back(from);
+            cost.push_back(c);
+            children.emplace_back();
+            if (from != -1)
+                children[from].push_back(id);
+            return id;
+        }
+
+        /** Moves a node under a new parent and updates the costs of its subtree.
+         * @param n node
+         * @param to new parent
+         * @param c new cost of n
+        */
+        void reparent(int n, int to, double c) {
+            std::vector<int>& siblings = children[parent[n]];
+            siblings.erase(std::find(siblings.begin(), siblings.end(), n));
+            parent[n] = to;
+            children[to].push_back(n);
+
+            const double delta = cost[n] - c;
+            std::vector<int> stack = {n};
+            while (!stack.empty()) {
+                const int m = stack.back();
+                stack.pop_back();
+                cost[m] -= delta;
+                stack.insert(stack.end(), children[m].begin(), children[m].end());
+            }
+        }
+    };
+
+    /** Checks an edge from a tree node (contacts at the root are ignored).
+     * @param tree search tree
+     * @param from tree node
+     * @param p other end
+     * @return true if the edge is free
+    */
+    bool edgeFree(const Tree& tree, int from, const Point& p) const {
+        return (from == 0) ? checker.segmentFreeFrom(tree.grid.point(0), p)
+                           : checker.segmentFree(tree.grid.point(from), p);
+    }
+
+    static constexpr float GRID_CELL = 0.05f;   ///< Neighbour index cell (m).
+
+    const CollisionChecker checker;     ///< Arena collision checker.
+    const Parameters parameters;        ///< Planner parameters.
+    std::mt19937 rng;                   ///< Sampling generator (kept across queries).
+    double gamma;                       ///< Rewiring radius constant.
+    size_t iterations = 0;              ///< Iterations of the last query.
+};
+
+}   // namespace Planning
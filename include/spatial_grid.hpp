@@ -0,0 +1,126 @@
+/** \file spatial_grid.hpp
+ * @brief Uniform grid index for nearest neighbour queries on points.
+ *
+ * The sampling based planners query the nearest samples of a point many
+ * times while the samples are being added. Points are bucketed in square
+ * cells; a query visits rings of cells around the point and stops as soon
+ * as no farther ring can hold a closer point.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+//! Point path planning
+namespace Planning {
+
+/** Point index on a uniform grid. Points outside the bounds go to the
+ * border cells.
+*/
+class PointGrid {
+public:
+    /** Creates an empty grid.
+     * @param minX smallest x of the indexed area
+     * @param minY smallest y of the indexed area
+     * @param maxX largest x of the indexed area
+     * @param maxY largest y of the indexed area
+     * @param cellSize cell side
+    */
+    PointGrid(float minX, float minY, float maxX, float maxY, float cellSize)
+        : originX(minX), originY(minY), cell(cellSize),
+          cols(std::max(1, static_cast<int>(std::ceil((maxX - minX) / cellSize)))),
+          rows(std::max(1, static_cast<int>(std::ceil((maxY - minY) / cellSize)))),
+          buckets(cols * rows) {}
+
+    /** Adds a point.
+     * @param p point
+     * @return index of the point
+    */
+    int insert(const Point& p) {
+        const int id = points.size();
+        points.push_back(p);
+        buckets[bucket(p)].push_back(id);
+        return id;
+    }
+
+    const Point& point(int id) const { return points[id]; }    ///< Point of an index.
+    size_t size() const { return points.size(); }              ///< Number of points.
+
+    /** Finds the k nearest points.
+     * @param p query point
+     * @param k number of points
+     * @return indices of the (at most) k nearest points, nearest first
+    */
+    std::vector<int> kNearest(const Point& p, size_t k) const {
+        std::vector<std::pair<float, int>> found;
+        const int cx = column(p.x), cy = row(p.y);
+        const int maxRing = std::max(std::max(cx, cols - 1 - cx), std::max(cy, rows - 1 - cy));
+        for (int ring = 0; ring <= maxRing; ++ring) {
+            for (int y = cy - ring; y <= cy + ring; ++y) {
+                if ((y < 0) || (y >= rows))
+                    continue;
+                // full rows on the ring edges, only the two ends in between
+                const int step = ((y == cy - ring) || (y == cy + ring)) ? 1 : std::max(1, 2 * ring);
+                for (int x = cx - ring; x <= cx + ring; x += step) {
+                    if ((x < 0) || (x >= cols))
+                        continue;
+                    for (int id : buckets[y * cols + x])
+                        found.emplace_back(std::hypot(points[id].x - p.x, points[id].y - p.y), id);
+                }
+            }
+            // points of the next rings are at least ring cells away
+            if (found.size() >= k) {
+                std::nth_element(found.begin(), found.begin() + (k - 1), found.end());
+                if (found[k - 1].first <= ring * cell)
+                    break;
+            }
+        }
+        const size_t n = std::min(k, found.size());
+        std::partial_sort(found.begin(), found.begin() + n, found.end());
+        std::vector<int> result;
+        for (size_t i = 0; i < n; ++i)
+            result.push_back(found[i].second);
+        return result;
+    }
+
+    /** Finds the nearest point.
+     * @param p query point
+     * @return index of the nearest point, -1 if the grid is empty
+    */
+    int nearest(const Point& p) const {
+        const std::vector<int> result = kNearest(p, 1);
+        return result.empty() ? -1 : result[0];
+    }
+
+    /** Finds the points within a distance.
+     * @param p query point
+     * @param radius distance
+     * @return indices of the points closer than radius
+    */
+    std::vector<int> withinRadius(const Point& p, float radius) const {
+        std::vector<int> result;
+        for (int y = row(p.y - radius); y <= row(p.y + radius); ++y)
+            for (int x = column(p.x - radius); x <= column(p.x + radius); ++x)
+                for (int id : buckets[y * cols + x])
+                    if (std::hypot(points[id].x - p.x, points[id].y - p.y) < radius)
+                        result.push_back(id);
+        return result;
+    }
+
+private:
+    int column(float x) const { return std::min(cols - 1, std::max(0, static_cast<int>((x - originX) / cell))); }
+    int row(float y) const { return std::min(rows - 1, std::max(0, static_cast<int>((y - originY) / cell))); }
+    int bucket(const Point& p) const { return row(p.y) * cols + column(p.x); }
+
+    float originX, originY;                 ///< Lower corner of the grid.
+    float cell;                             ///< Cell side.
+    int cols, rows;                         ///< Grid size (cells).
+    std::vector<std::vector<int>> buckets;  ///< Points of every cell.
+    std::vector<Point> points;              ///< Indexed points.
+};
+
+}   // namespace Planning
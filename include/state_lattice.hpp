@@ -0,0 +1,350 @@
+/** \file state_lattice.hpp
+ * @brief State lattice A* planner of Dubins paths.
+ *
+ * The states are cell centers with one of a fixed set of headings. The
+ * motion primitives are the shortest Dubins curves (robot maximum curvature)
+ * from a state to the states about one primitive length ahead, with a small
+ * heading change; they are computed once with the cells they sweep. A
+ * primitive is then valid from a state if none of its swept cells touches an
+ * obstacle, which is a table lookup.
+ *
+ * A* expands the states by path length plus the obstacle free Dubins length
+ * to the goal. The start pose is joined to the lattice with Dubins curves to
+ * the states around it; every expanded state near the goal tries a direct
+ * Dubins curve to it and the search stops at the first free one. The
+ * expansions are limited, so the planning time is bounded.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "collision_checker.hpp"
+#include "dubins.hpp"
+#include "dubins_collision.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//! Point path planning
+namespace Planning {
+
+/** State lattice planner of Dubins paths. */
+class StateLattice {
+public:
+    /** Planner parameters. */
+    struct Parameters {
+        double kMax = 10;               ///< Maximum curvature.
+        float cell = 0.02f;             ///< Lattice cell side (m).
+        unsigned int headings = 16;     ///< Lattice headings.
+        double primitiveLength = 0.2;   ///< Distance reached by a primitive (m).
+        int headingChange = 4;          ///< Largest heading change of a primitive (headings).
+        double goalRadius = 0.4;        ///< States closer than this try to reach the goal (m).
+        unsigned int goalHeadings = 8;  ///< Headings tried at a goal with free heading.
+        size_t maxExpansions = 20000;   ///< Expansion limit of a query.
+        double resolution = 0.01;       ///< Curve discretization for collision checks (m).
+    };
+
+    /** Creates the planner: computes the blocked cells and the primitives.
+     * @param checker collision checker of the arena
+     * @param parameters planner parameters
+    */
+    StateLattice(const CollisionChecker& checker, const Parameters& parameters)
+        : checker(checker), parameters(parameters),
+          cols(std::max(1, static_cast<int>(std::ceil((checker.maxXBound() - checker.minXBound()) / parameters.cell)))),
+          rows(std::max(1, static_cast<int>(std::ceil((checker.maxYBound() - checker.minYBound()) / parameters.cell)))) {
+        // a cell is blocked if its square is not entirely free
+        blocked.resize(cols * rows);
+        const float h = parameters.cell / 2;
+        for (int y = 0; y < rows; ++y)
+            for (int x = 0; x < cols; ++x) {
+                const Point c = center(x, y);
+                const Point corners[4] = { Point(c.x - h, c.y - h), Point(c.x + h, c.y - h),
+                                           Point(c.x + h, c.y + h), Point(c.x - h, c.y + h) };
+                bool free = checker.pointFree(c);
+                for (int i = 0; free && (i < 4); ++i)
+                    free = checker.segmentFree(corners[i], corners[(i + 1) % 4]);
+                blocked[y * cols + x] = !free;
+            }
+
+        // primitives from the origin (a cell center) for every heading
+        primitives.resize(parameters.headings);
+        for (unsigned int th = 0; th < parameters.headings; ++th)
+            for (Motion& m : motions(0, 0, heading(th), th, [this](int dx, int dy) {
+                                         return Point(dx * this->parameters.cell, dy * this->parameters.cell);
+                                     })) {
+                m.cells = sweptCells(m.curve);
+                primitives[th].push_back(m);
+            }
+    }
+
+    /** Plans a Dubins path between two poses.
+     * Throws std::runtime_error("Path not found!") if there is no path.
+     * @param x0 starting point x coordinate
+     * @param y0 starting point y coordinate
+     * @param th0 starting angle
+     * @param xf arrival point x coordinate
+     * @param yf arrival point y coordinate
+     * @param thf arrival angle (ignored with freeHeading)
+     * @param freeHeading true if any arrival angle is fine
+     * @return the Dubins curves, from start to goal
+    */
+    std::vector<dubins::Curve> plan(double x0, double y0, double th0,
+                                    double xf, double yf, double thf, bool freeHeading) {
+        expansions = 0;
+        const Point goal(xf, yf);
+        dubins::Curve arrival;
+        if (freeCurveTo(checker, x0, y0, th0, goal, thf, freeHeading, parameters.goalHeadings,
+                        parameters.kMax, parameters.resolution, true, arrival))
+            return {arrival};
+
+        const size_t states = static_cast<size_t>(cols) * rows * parameters.headings;
+        std::vector<double> cost(states, std::numeric_limits<double>::infinity());
+        std::vector<int> parent(states, -1);
+        std::vector<int> via(states, -1);   // primitive from the parent, -1 from the start
+        std::vector<char> closed(states, 0);
+        std::unordered_map<int, dubins::Curve> fromStart;
+        typedef std::pair<double, int> Entry;   // (estimated total length, state)
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+        // the start pose joins the lattice states around it
+        const int sx = column(x0), sy = row(y0);
+        const unsigned int sth = nearestHeading(th0);
+        for (const Motion& m : motions(x0, y0, th0, sth, [this, sx, sy](int dx, int dy) {
+                                           return this->center(sx + dx, sy + dy);
+                                       })) {
+            const int cx = sx + m.dx, cy = sy + m.dy;
+            if (!inside(cx, cy) || blocked[cy * cols + cx] ||
+                !curveFree(checker, m.curve, parameters.resolution, true, false))
+                continue;
+            const int s = state(cx, cy, m.heading);
+            if (m.curve.L < cost[s]) {
+                cost[s] = m.curve.L;
+                fromStart[s] = m.curve;
+                open.emplace(cost[s] + heuristic(s, goal, thf, freeHeading), s);
+            }
+        }
+
+        int last = -1;  // state reaching the goal
+        while (!open.empty() && (last == -1)) {
+            const int s = open.top().second;
+            open.pop();
+            if (closed[s])
+                continue;
+            closed[s] = 1;
+            if (++expansions > parameters.maxExpansions)
+                break;
+
+            const int cx = cellX(s), cy = cellY(s);
+            const unsigned int th = stateHeading(s);
+            const Point p = center(cx, cy);
+            if ((distance(p, goal) <= parameters.goalRadius) &&
+                freeCurveTo(checker, p.x, p.y, heading(th), goal, thf, freeHeading, parameters.goalHeadings,
+                            parameters.kMax, parameters.resolution, false, arrival)) {
+                last = s;
+                break;
+            }
+
+            for (size_t i = 0; i < primitives[th].size(); ++i) {
+                const Motion& m = primitives[th][i];
+                const int nx = cx + m.dx, ny = cy + m.dy;
+                if (!inside(nx, ny) || !sweepFree(cx, cy, m))
+                    continue;
+                const int n = state(nx, ny, m.heading);
+                const double c = cost[s] + m.curve.L;
+                if (!closed[n] && (c < cost[n])) {
+                    cost[n] = c;
+                    parent[n] = s;
+                    via[n] = i;
+                    open.emplace(c + heuristic(n, goal, thf, freeHeading), n);
+                }
+            }
+        }
+        if (last == -1)
+            throw std::runtime_error("Path not found!");
+
+        std::vector<dubins::Curve> path = {arrival};
+        for (int s = last; ; s = parent[s]) {
+            if (parent[s] == -1) {
+                path.push_back(fromStart[s]);
+                break;
+            }
+            const dubins::Curve& c = primitives[stateHeading(parent[s])][via[s]].curve;
+            const Point p = center(cellX(parent[s]), cellY(parent[s]));
+            path.push_back(dubins::Curve(p.x, p.y, c.a1.th0, c.a1.L, c.a2.L, c.a3.L, c.a1.k, c.a2.k, c.a3.k));
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    /** Plans a Dubins path through a list of points.
+     * Any heading is fine at the intermediate points.
+     * Throws std::runtime_error("Path not found!") if a leg has no path.
+     * @param x0 starting point x coordinate
+     * @param y0 starting point y coordinate
+     * @param th0 starting angle
+     * @param waypoints points to go through, in order
+     * @param xf arrival point x coordinate
+     * @param yf arrival point y coordinate
+     * @param thf arrival angle
+     * @return the Dubins curves, from start to goal
+    */
+    std::vector<dubins::Curve> planThrough(double x0, double y0, double th0, const std::vector<Point>& waypoints,
+                                           double xf, double yf, double thf) {
+        std::vector<dubins::Curve> path;
+        size_t total = 0;
+        for (size_t i = 0; i <= waypoints.size(); ++i) {
+            const bool isLast = (i == waypoints.size());
+            const Point target = isLast ? Point(xf, yf) : waypoints[i];
+            const std::vector<dubins::Curve> leg = plan(x0, y0, th0, target.x, target.y, thf, !isLast);
+            total += expansions;
+            path.insert(path.end(), leg.begin(), leg.end());
+            x0 = leg.back().a3.xf;
+            y0 = leg.back().a3.yf;
+            th0 = leg.back().a3.thf;
+        }
+        expansions = total;
+        return path;
+    }
+
+    size_t lastExpansions() const { return expansions; }    ///< Expanded states of the last query.
+
+    /** @return the number of motion primitives (all headings) */
+    size_t primitiveCount() const {
+        size_t count = 0;
+        for (const std::vector<Motion>& p : primitives)
+            count += p.size();
+        return count;
+    }
+
+private:
+    /** Motion to a lattice state. */
+    struct Motion {
+        int dx, dy;                             ///< Arrival cell offset.
+        unsigned int heading;                   ///< Arrival heading index.
+        dubins::Curve curve;                    ///< Dubins curve of the motion.
+        std::vector<std::pair<int, int>> cells; ///< Swept cell offsets (primitives only).
+    };
+
+    /** Computes the motions from a pose to the states about a primitive length ahead.
+     * @param x starting point x coordinate
+     * @param y starting point y coordinate
+     * @param th starting angle
+     * @param index lattice heading nearest to th
+     * @param target position of the state at a cell offset
+     * @return the motions
+    */
+    std::vector<Motion> motions(double x, double y, double th, unsigned int index,
+                                const std::function<Point(int, int)>& target) const {
+        std::vector<Motion> result;
+        const int reach = static_cast<int>(std::round(parameters.primitiveLength / parameters.cell));
+        const int headings = parameters.headings;
+        for (int dy = -reach; dy <= reach; ++dy)
+            for (int dx = -reach; dx <= reach; ++dx) {
+                // cells on the ring at the primitive length, ahead of the heading
+                const double r = std::hypot(dx, dy);
+                if ((r < reach - 0.5) || (r > reach + 0.5))
+                    continue;
+                const Point t = target(dx, dy);
+                const double ahead = std::cos(std::atan2(t.y - y, t.x - x) - th);
+                if (ahead < std::cos(M_PI / 3))
+                    continue;
+                for (int dh = -parameters.headingChange; dh <= parameters.headingChange; ++dh) {
+                    const unsigned int h = (index + headings + dh) % headings;
+                    int pidx;
+                    dubins::Curve c = dubins::dubins_shortest_path(x, y, th, t.x, t.y, heading(h), parameters.kMax, pidx);
+                    // no loops: the curve is not much longer than the straight line
+                    if ((pidx >= 0) && (c.L <= MAX_DETOUR * std::hypot(t.x - x, t.y - y)))
+                        result.push_back({dx, dy, h, c, {}});
+                }
+            }
+        return result;
+    }
+
+    /** Computes the cells swept by a primitive from the origin cell.
+     * Diagonal moves between samples add both side cells.
+     * @param curve primitive curve
+     * @return the swept cell offsets
+    */
+    std::vector<std::pair<int, int>> sweptCells(dubins::Curve curve) const {
+        std::vector<std::pair<int, int>> cells;
+        std::pair<int, int> previous(0, 0);
+        cells.push_back(previous);
+        std::vector<dubins::Position> samples = curve.discretizeSingleCurve(parameters.cell / 4);
+        samples.push_back(dubins::Position(curve.L, curve.a3.xf, curve.a3.yf, curve.a3.thf, curve.a3.k));
+        for (const dubins::Position& p : samples) {
+            const std::pair<int, int> c(static_cast<int>(std::floor(p.x / parameters.cell + 0.5)),
+                                        static_cast<int>(std::floor(p.y / parameters.cell + 0.5)));
+            if ((c.first != previous.first) && (c.second != previous.second)) {
+                cells.emplace_back(c.first, previous.second);
+                cells.emplace_back(previous.first, c.second);
+            }
+            cells.push_back(c);
+            previous = c;
+        }
+        std::sort(cells.begin(), cells.end());
+        cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+        return cells;
+    }
+
+    /** Checks the swept cells of a primitive from a cell.
+     * @return true if they are all inside and free
+    */
+    bool sweepFree(int x, int y, const Motion& m) const {
+        for (const std::pair<int, int>& c : m.cells) {
+            const int cx = x + c.first, cy = y + c.second;
+            if (!inside(cx, cy) || blocked[cy * cols + cx])
+                return false;
+        }
+        return true;
+    }
+
+    /** Estimates the length from a state to the goal, ignoring the obstacles.
+     * @return the Dubins length (straight line length with a free heading)
+    */
+    double heuristic(int s, const Point& goal, double thf, bool freeHeading) const {
+        const Point p = center(cellX(s), cellY(s));
+        const double straight = distance(p, goal);
+        if (freeHeading)
+            return straight;
+        int pidx;
+        dubins::Curve c = dubins::dubins_shortest_path(p.x, p.y, heading(stateHeading(s)), goal.x, goal.y, thf,
+                                                       parameters.kMax, pidx);
+        return (pidx >= 0) ? c.L : straight;
+    }
+
+    double heading(unsigned int h) const { return 2 * M_PI * h / parameters.headings; }    ///< Angle of a heading index.
+    unsigned int nearestHeading(double th) const {  ///< Heading index nearest to an angle.
+        const int h = static_cast<int>(std::round(th / (2 * M_PI) * parameters.headings));
+        const int headings = parameters.headings;
+        return ((h % headings) + headings) % headings;
+    }
+
+    Point center(int x, int y) const {  ///< Center of a cell.
+        return Point(checker.minXBound() + (x + 0.5f) * parameters.cell, checker.minYBound() + (y + 0.5f) * parameters.cell);
+    }
+    int column(float x) const { return std::min(cols - 1, std::max(0, static_cast<int>((x - checker.minXBound()) / parameters.cell))); }
+    int row(float y) const { return std::min(rows - 1, std::max(0, static_cast<int>((y - checker.minYBound()) / parameters.cell))); }
+    bool inside(int x, int y) const { return (x >= 0) && (x < cols) && (y >= 0) && (y < rows); }
+
+    int state(int x, int y, unsigned int h) const { return (y * cols + x) * parameters.headings + h; }
+    int cellX(int s) const { return (s / parameters.headings) % cols; }
+    int cellY(int s) const { return (s / parameters.headings) / cols; }
+    unsigned int stateHeading(int s) const { return s % parameters.headings; }
+
+    static constexpr double MAX_DETOUR = 1.3;   ///< Longest primitive over its straight line length.
+
+    const CollisionChecker checker;                 ///< Arena collision checker.
+    const Parameters parameters;                    ///< Planner parameters.
+    const int cols, rows;                           ///< Lattice size (cells).
+    std::vector<char> blocked;                      ///< Cells touching an obstacle or outside the borders.
+    std::vector<std::vector<Motion>> primitives;    ///< Primitives of every heading.
+    size_t expansions = 0;                          ///< Expanded states of the last query.
+};
+
+}   // namespace Planning
@@ -0,0 +1,338 @@
+/** \file vertical_cell_decomposition.hpp
+ * @brief Vertical cell decomposition point planner.
+ *
+ * Native version of src/path-planning/vertical_cell_decomposition.py. The
+ * free space is split by vertical lines through every vertex into
+ * trapezoidal cells; the roadmap links the center of every cell to the
+ * middle of the doors it shares with its neighbours. The decomposition and
+ * the roadmap are computed once per map; a query locates the cells of its
+ * endpoints and runs A* on the roadmap, so the result is deterministic.
+ *
+ * Cells are first computed on the slabs between consecutive vertex
+ * abscissae, then the slab cells bounded by the same two edges are merged.
+ * Edge crossings (e.g. overlapping obstacles) are treated as vertices.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "collision_checker.hpp"
+#include "graph_search.hpp"
+#include "point_planner.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+//! Point path planning
+namespace Planning {
+
+/** Vertical cell decomposition planner. */
+class VerticalCellDecomposition : public PointPlanner {
+public:
+    /** Non vertical edge of the borders or of an obstacle. */
+    struct Segment {
+        Point a;    ///< Left vertex.
+        Point b;    ///< Right vertex.
+
+        /** @return y of the segment line at x */
+        float yAt(float x) const { return a.y + (b.y - a.y) * (x - a.x) / (b.x - a.x); }
+    };
+
+    /** Trapezoidal cell, bounded by two segments and two vertical lines. */
+    struct Cell {
+        float x0;               ///< Left side.
+        float x1;               ///< Right side.
+        int bottom;             ///< Lower segment.
+        int top;                ///< Upper segment.
+        std::vector<int> doors; ///< Roadmap nodes of the doors to the neighbour cells.
+    };
+
+    /** Computes the decomposition and the roadmap.
+     * @param checker collision checker of the arena
+    */
+    explicit VerticalCellDecomposition(const CollisionChecker& checker) {
+        addPolygon(checker.borders());
+        for (const Polygon& obstacle : checker.obstacles())
+            addPolygon(obstacle);
+
+        // slab boundaries: vertices and edge crossings
+        std::vector<float> xs;
+        addAbscissae(checker.borders(), xs);
+        for (const Polygon& obstacle : checker.obstacles())
+            addAbscissae(obstacle, xs);
+        for (size_t i = 0; i < segments.size(); ++i)
+            for (size_t j = i + 1; j < segments.size(); ++j) {
+                float x;
+                if (crossing(segments[i], segments[j], x))
+                    xs.push_back(x);
+            }
+        std::sort(xs.begin(), xs.end());
+        xs.erase(std::unique(xs.begin(), xs.end(),
+                             [](float l, float r) { return r - l < MIN_SLAB_WIDTH; }), xs.end());
+
+        // cells of every slab, merged with the cell of the previous slab
+        // bounded by the same segments
+        std::vector<int> previous;
+        for (size_t s = 0; s + 1 < xs.size(); ++s) {
+            const float x0 = xs[s], x1 = xs[s + 1], xm = (x0 + x1) / 2;
+            std::vector<int> spanning;
+            for (size_t k = 0; k < segments.size(); ++k)
+                if ((segments[k].a.x < x0 + MIN_SLAB_WIDTH) && (segments[k].b.x > x1 - MIN_SLAB_WIDTH))
+                    spanning.push_back(k);
+            std::sort(spanning.begin(), spanning.end(), [&](int l, int r) {
+                return segments[l].yAt(xm) < segments[r].yAt(xm);
+            });
+
+            std::vector<int> current;
+            for (size_t k = 0; k + 1 < spanning.size(); ++k) {
+                const int bottom = spanning[k], top = spanning[k + 1];
+                const Point middle(xm, (segments[bottom].yAt(xm) + segments[top].yAt(xm)) / 2);
+                if (!checker.pointFree(middle))
+                    continue;
+
+                int id = -1;
+                for (int c : previous)
+                    if ((cells[c].bottom == bottom) && (cells[c].top == top) && (cells[c].x1 == x0))
+                        id = c;
+                if (id == -1) {
+                    id = cells.size();
+                    cells.push_back({x0, x1, bottom, top, {}});
+                } else {
+                    cells[id].x1 = x1;
+                }
+                current.push_back(id);
+            }
+            previous = current;
+        }
+
+        for (size_t c = 0; c < cells.size(); ++c) {
+            roadmap.addNode();
+            points.push_back(center(cells[c]));
+        }
+        // doors between cells sharing part of a vertical side
+        for (size_t l = 0; l < cells.size(); ++l)
+            for (size_t r = 0; r < cells.size(); ++r)
+                if (cells[l].x1 == cells[r].x0)
+                    addDoor(l, r);
+    }
+
+    std::vector<Point> plan(const Point& start, const Point& goal) override {
+        const int startCell = locate(start);
+        const int goalCell = locate(goal);
+        if ((startCell == -1) || (goalCell == -1))
+            throw std::runtime_error("Path not found!");
+        if (startCell == goalCell)
+            return {start, goal};   // cells are convex
+
+        Graph g = roadmap;
+        std::vector<Point> nodes = points;
+        const int s = connect(g, nodes, start, startCell);
+        const int t = connect(g, nodes, goal, goalCell);
+
+        std::vector<int> route;
+        if (!aStar(g, s, t, [&](int n) { return distance(nodes[n], goal); }, route))
+            throw std::runtime_error("Path not found!");
+
+        std::vector<Point> path;
+        for (int n : route)
+            path.push_back(nodes[n]);
+        return path;
+    }
+
+    std::string name() const override { return "vertical cell decomposition"; }
+
+    /** Roadmap path lengths from a point to several targets (one Dijkstra run).
+     * @param source source point
+     * @param targets target points
+     * @return roadmap path length of every target (infinity if unreachable)
+    */
+    std::vector<double> distancesFrom(const Point& source, const std::vector<Point>& targets) override {
+        std::vector<double> result(targets.size(), std::numeric_limits<double>::infinity());
+        const int sourceCell = locate(source);
+        if (sourceCell == -1)
+            return result;
+
+        Graph g = roadmap;
+        std::vector<Point> nodes = points;
+        const int s = connect(g, nodes, source, sourceCell);
+        std::vector<double> cost;
+        std::vector<int> parent;
+        dijkstra(g, s, cost, parent);
+
+        for (size_t k = 0; k < targets.size(); ++k) {
+            const int cell = locate(targets[k]);
+            if (cell == -1)
+                continue;
+            if (cell == sourceCell) {
+                result[k] = distance(source, targets[k]);
+                continue;
+            }
+            // last hop from the center or a door of the target cell
+            result[k] = cost[cell] + distance(points[cell], targets[k]);
+            for (int d : cells[cell].doors)
+                result[k] = std::min(result[k], cost[d] + distance(points[d], targets[k]));
+        }
+        return result;
+    }
+
+    /** Finds the cell containing a point.
+     * Points within LOCATE_TOLERANCE of a cell (e.g. on the borders) belong
+     * to the nearest cell.
+     * @param p point
+     * @return cell index, -1 if p is not in free space
+    */
+    int locate(const Point& p) const {
+        int best = -1;
+        float bestDistance = LOCATE_TOLERANCE;
+        for (size_t c = 0; c < cells.size(); ++c) {
+            const Cell& cell = cells[c];
+            const float x = std::min(std::max(p.x, cell.x0), cell.x1);
+            const float dx = p.x - x;
+            const float dy = std::max(0.f, std::max(segments[cell.bottom].yAt(x) - p.y,
+                                                    p.y - segments[cell.top].yAt(x)));
+            const float d = std::hypot(dx, dy);
+            if (d < bestDistance) {
+                best = c;
+                bestDistance = d;
+                if (d == 0)
+                    break;
+            }
+        }
+        return best;
+    }
+
+    const std::vector<Cell>& cellList() const { return cells; }        ///< Cells.
+    size_t nodeCount() const { return roadmap.size(); }                 ///< Roadmap nodes.
+    size_t edgeCount() const { return roadmap.edgeCount(); }            ///< Roadmap edges.
+
+private:
+    /** Adds the edges of a closed polygon.
+     * @param polygon polygon
+    */
+    void addPolygon(const Polygon& polygon) {
+        for (size_t k = 0; k < polygon.size(); ++k) {
+            Point a = polygon[k];
+            Point b = polygon[(k + 1) % polygon.size()];
+            if (std::abs(a.x - b.x) < MIN_SLAB_WIDTH) {
+                if (a.y > b.y)
+                    std::swap(a, b);
+                walls.push_back({a, b});
+            } else {
+                if (a.x > b.x)
+                    std::swap(a, b);
+                segments.push_back({a, b});
+            }
+        }
+    }
+
+    /** Adds the vertex abscissae of a polygon.
+     * @param polygon polygon
+     * @param xs output abscissae
+    */
+    static void addAbscissae(const Polygon& polygon, std::vector<float>& xs) {
+        for (const Point& p : polygon)
+            xs.push_back(p.x);
+    }
+
+    /** Finds where two segments cross (away from their vertices).
+     * @param s first segment
+     * @param r second segment
+     * @param x output abscissa of the crossing
+     * @return true if the segments cross
+    */
+    static bool crossing(const Segment& s, const Segment& r, float& x) {
+        const float lo = std::max(s.a.x, r.a.x), hi = std::min(s.b.x, r.b.x);
+        if (hi - lo < 2 * MIN_SLAB_WIDTH)
+            return false;
+        const float dLo = s.yAt(lo) - r.yAt(lo);
+        const float dHi = s.yAt(hi) - r.yAt(hi);
+        if (dLo * dHi >= 0)
+            return false;
+        x = lo + (hi - lo) * dLo / (dLo - dHi);
+        return true;
+    }
+
+    /** @return the center of a cell (mean of its corners) */
+    Point center(const Cell& cell) const {
+        const Segment& b = segments[cell.bottom];
+        const Segment& t = segments[cell.top];
+        return Point((cell.x0 + cell.x1) / 2,
+                     (b.yAt(cell.x0) + b.yAt(cell.x1) + t.yAt(cell.x0) + t.yAt(cell.x1)) / 4);
+    }
+
+    /** Adds the door between two cells, if their common side is open.
+     * The door is the middle of the longest part of the common side not
+     * covered by a vertical edge.
+     * @param l left cell
+     * @param r right cell
+    */
+    void addDoor(int l, int r) {
+        const float x = cells[l].x1;
+        const float lo = std::max(segments[cells[l].bottom].yAt(x), segments[cells[r].bottom].yAt(x));
+        const float hi = std::min(segments[cells[l].top].yAt(x), segments[cells[r].top].yAt(x));
+        if (hi - lo < MIN_SLAB_WIDTH)
+            return;
+
+        // free parts of [lo, hi]
+        std::vector<std::pair<float, float>> open = {{lo, hi}};
+        for (const Segment& w : walls) {
+            if (std::abs(w.a.x - x) >= MIN_SLAB_WIDTH)
+                continue;
+            std::vector<std::pair<float, float>> next;
+            for (const std::pair<float, float>& o : open) {
+                if (w.a.y > o.first)
+                    next.emplace_back(o.first, std::min(o.second, w.a.y));
+                if (w.b.y < o.second)
+                    next.emplace_back(std::max(o.first, w.b.y), o.second);
+            }
+            open = next;
+        }
+        float best = MIN_SLAB_WIDTH, y = 0;
+        for (const std::pair<float, float>& o : open)
+            if (o.second - o.first >= best) {
+                best = o.second - o.first;
+                y = (o.first + o.second) / 2;
+            }
+        if (best == MIN_SLAB_WIDTH)
+            return;
+
+        const Point door(x, y);
+        const int id = roadmap.addNode();
+        points.push_back(door);
+        roadmap.addEdge(l, id, distance(points[l], door));
+        roadmap.addEdge(id, r, distance(door, points[r]));
+        cells[l].doors.push_back(id);
+        cells[r].doors.push_back(id);
+    }
+
+    /** Adds a query point to a copy of the roadmap, linked to the center and
+     * the doors of its cell (cells are convex).
+     * @param g roadmap copy
+     * @param nodes points of the roadmap copy
+     * @param p query point
+     * @param cell cell of p
+     * @return node of the query point
+    */
+    int connect(Graph& g, std::vector<Point>& nodes, const Point& p, int cell) const {
+        const int id = g.addNode();
+        nodes.push_back(p);
+        g.addEdge(id, cell, distance(p, points[cell]));
+        for (int d : cells[cell].doors)
+            g.addEdge(id, d, distance(p, points[d]));
+        return id;
+    }
+
+    static constexpr float MIN_SLAB_WIDTH = 1e-5f;      ///< Narrower slabs are merged (m).
+    static constexpr float LOCATE_TOLERANCE = 1e-3f;    ///< Query points farther from every cell are not free (m).
+
+    std::vector<Segment> segments;  ///< Non vertical edges.
+    std::vector<Segment> walls;     ///< Vertical edges (a below b).
+    std::vector<Cell> cells;        ///< Cells, ordered by their left side.
+    std::vector<Point> points;      ///< Roadmap nodes: cell centers, then doors.
+    Graph roadmap;                  ///< Center-door-center roadmap.
+};
+
+}   // namespace Planning
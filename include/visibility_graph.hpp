@@ -0,0 +1,210 @@
+/** \file visibility_graph.hpp
+ * @brief Visibility graph point planner.
+ *
+ * In a polygonal arena the Euclidean shortest path bends only at obstacle and
+ * border vertices. The graph connects every pair of mutually visible
+ * vertices once per map; a query connects its endpoints to the vertices they
+ * see and runs A* (or Dijkstra for one-to-all distances).
+ *
+ * The vertices must lie strictly in free space, so they are taken from the
+ * checked obstacles inflated (and the borders deflated) by a small margin:
+ * visibility is checked against the polygons of the collision checker, so
+ * the clearance of the paths is the one of the obstacles it is built with.
+ * Query points may lie on the borders (e.g. the arrival point in front of the
+ * gate): contacts at the query point itself are ignored.
+ *
+ * The visibility among obstacle vertices does not depend on the borders, so
+ * it can be computed as soon as the obstacles are known
+ * (ObstacleVisibility); the graph then only checks those edges and the edges
+ * of the border vertices against the borders.
+ *
+ * Date: 19/10/2026
+*/
+#pragma once
+
+#include "collision_checker.hpp"
+#include "graph_search.hpp"
+#include "point_planner.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+//! Point path planning
+namespace Planning {
+
+/** Visibility among the vertices around the obstacles, borders excluded. */
+struct ObstacleVisibility {
+    std::vector<Point> vertices;                ///< Vertices outside every obstacle.
+    std::vector<std::pair<int, int>> edges;     ///< Vertex pairs that see each other past the obstacles.
+
+    /** Checks the candidate vertices against the obstacles only.
+     * @param obstacles obstacle polygons
+     * @param candidates candidate vertices (vertices inside an obstacle are dropped)
+    */
+    ObstacleVisibility(const std::vector<Polygon>& obstacles, const std::vector<Point>& candidates) {
+        if (candidates.empty())
+            return;
+        // borders enclosing every vertex, so only the obstacles count
+        float minX = std::numeric_limits<float>::max(), minY = std::numeric_limits<float>::max();
+        float maxX = std::numeric_limits<float>::lowest(), maxY = std::numeric_limits<float>::lowest();
+        for (const Point& p : candidates) {
+            minX = std::min(minX, p.x);
+            minY = std::min(minY, p.y);
+            maxX = std::max(maxX, p.x);
+            maxY = std::max(maxY, p.y);
+        }
+        const CollisionChecker checker({Point(minX - 1, minY - 1), Point(maxX + 1, minY - 1),
+                                        Point(maxX + 1, maxY + 1), Point(minX - 1, maxY + 1)}, obstacles);
+        for (const Point& v : candidates)
+            if (checker.pointFree(v))
+                vertices.push_back(v);
+        for (size_t i = 0; i < vertices.size(); ++i)
+            for (size_t j = i + 1; j < vertices.size(); ++j)
+                if (checker.segmentFree(vertices[i], vertices[j]))
+                    edges.emplace_back(i, j);
+    }
+};
+
+/** Visibility graph planner. */
+class VisibilityGraph : public PointPlanner {
+public:
+    /** Builds the graph.
+     * @param checker collision checker of the arena
+     * @param vertices candidate vertices (vertices outside free space are dropped)
+    */
+    VisibilityGraph(const CollisionChecker& checker, const std::vector<Point>& vertices)
+        : checker(checker) {
+        for (const Point& v : vertices) {
+            if (checker.pointFree(v)) {
+                nodes.push_back(v);
+                graph.addNode();
+            }
+        }
+        for (size_t i = 0; i < nodes.size(); ++i)
+            for (size_t j = i + 1; j < nodes.size(); ++j)
+                if (checker.segmentFree(nodes[i], nodes[j]))
+                    graph.addEdge(i, j, distance(nodes[i], nodes[j]));
+    }
+
+    /** Builds the graph on the prebuilt obstacle visibility.
+     * Same graph as with the obstacle vertices followed by the border
+     * vertices as candidates.
+     * @param checker collision checker of the arena (same obstacles as visibility)
+     * @param visibility visibility among the obstacle vertices
+     * @param borderVertices candidate vertices along the borders
+    */
+    VisibilityGraph(const CollisionChecker& checker, const ObstacleVisibility& visibility,
+                    const std::vector<Point>& borderVertices)
+        : checker(checker) {
+        const CollisionChecker borderChecker(checker.borders(), {});
+        std::vector<int> node(visibility.vertices.size(), -1);    // node of every obstacle vertex
+        std::vector<int> vertex;                                // obstacle vertex of every node
+        for (size_t i = 0; i < visibility.vertices.size(); ++i) {
+            if (borderChecker.pointFree(visibility.vertices[i])) {
+                node[i] = nodes.size();
+                vertex.push_back(i);
+                nodes.push_back(visibility.vertices[i]);
+                graph.addNode();
+            }
+        }
+        for (const Point& v : borderVertices) {
+            if (checker.pointFree(v)) {
+                nodes.push_back(v);
+                graph.addNode();
+            }
+        }
+
+        // edges in the same order as the other constructor
+        size_t e = 0;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            if (i < vertex.size()) {
+                // pairs of obstacle vertices: only the borders are left to check
+                for (; (e < visibility.edges.size()) && (visibility.edges[e].first < vertex[i]); ++e);
+                for (; (e < visibility.edges.size()) && (visibility.edges[e].first == vertex[i]); ++e) {
+                    const int j = node[visibility.edges[e].second];
+                    if ((j != -1) && borderChecker.segmentFree(nodes[i], nodes[j]))
+                        graph.addEdge(i, j, distance(nodes[i], nodes[j]));
+                }
+            }
+            for (size_t j = std::max(i + 1, vertex.size()); j < nodes.size(); ++j)
+                if (checker.segmentFree(nodes[i], nodes[j]))
+                    graph.addEdge(i, j, distance(nodes[i], nodes[j]));
+        }
+    }
+
+    std::vector<Point> plan(const Point& start, const Point& goal) override {
+        if (checker.segmentFreeFrom(start, goal) && checker.segmentFreeFrom(goal, start))
+            return {start, goal};
+
+        Graph g = graph;
+        std::vector<Point> points = nodes;
+        const int s = connect(g, points, start);
+        const int t = connect(g, points, goal);
+
+        std::vector<int> route;
+        if (!aStar(g, s, t, [&](int n) { return distance(points[n], goal); }, route))
+            throw std::runtime_error("Path not found!");
+
+        std::vector<Point> path;
+        for (int n : route)
+            path.push_back(points[n]);
+        return path;
+    }
+
+    std::string name() const override { return "visibility graph"; }
+
+    /** Shortest path lengths from a point to several targets (one Dijkstra run).
+     * @param source source point
+     * @param targets target points
+     * @return path length of every target (infinity if unreachable)
+    */
+    std::vector<double> distancesFrom(const Point& source, const std::vector<Point>& targets) override {
+        std::vector<double> result(targets.size(), std::numeric_limits<double>::infinity());
+        Graph g = graph;
+        std::vector<Point> points = nodes;
+        const int s = connect(g, points, source);
+        std::vector<double> cost;
+        std::vector<int> parent;
+        dijkstra(g, s, cost, parent);
+
+        for (size_t k = 0; k < targets.size(); ++k) {
+            if (checker.segmentFreeFrom(source, targets[k]) && checker.segmentFreeFrom(targets[k], source)) {
+                result[k] = distance(source, targets[k]);
+                continue;
+            }
+            // last hop from any vertex the target sees
+            for (size_t n = 0; n < nodes.size(); ++n)
+                if ((cost[n] + distance(nodes[n], targets[k]) < result[k]) &&
+                    checker.segmentFreeFrom(targets[k], nodes[n]))
+                    result[k] = cost[n] + distance(nodes[n], targets[k]);
+        }
+        return result;
+    }
+
+    size_t nodeCount() const { return graph.size(); }       ///< Number of vertices.
+    size_t edgeCount() const { return graph.edgeCount(); }  ///< Number of visibility edges.
+
+private:
+    /** Adds a query point to a copy of the graph.
+     * @param g graph copy
+     * @param points vertices of the graph copy
+     * @param p query point
+     * @return node of the query point
+    */
+    int connect(Graph& g, std::vector<Point>& points, const Point& p) const {
+        const int id = g.addNode();
+        points.push_back(p);
+        for (size_t n = 0; n < nodes.size(); ++n)
+            if (checker.segmentFreeFrom(p, nodes[n]))
+                g.addEdge(id, n, distance(p, nodes[n]));
+        return id;
+    }
+
+    const CollisionChecker checker;     ///< Arena collision checker.
+    std::vector<Point> nodes;           ///< Graph vertices.
+    Graph graph;                        ///< Visibility edges.
+};
+
+}   // namespace Planning
@@ -26,7 +26,9 @@ static void help()
     cout <<  "This is a camera calibration sample." << endl
          <<  "Usage: camera_calibration [configuration_file -- default ./default.xml]"  << endl
          <<  "Near the sample file you'll find the configuration file, which has detailed help of "
-             "how to edit it.  It may be any OpenCV supported file format XML/YAML." << endl;
+             "how to edit it.  It may be any OpenCV supported file format XML/YAML." << endl
+         <<  "With an image list and Calibrate_BatchMode set, all the images are processed in "
+             "parallel without the interactive view." << endl;
 }
 class Settings
 {
@@ -46,6 +48,7 @@ public:
                   << "Calibrate_FixAspectRatio" << aspectRatio
                   << "Calibrate_AssumeZeroTangentialDistortion" << calibZeroTangentDist
                   << "Calibrate_FixPrincipalPointAtTheCenter" << calibFixPrincipalPoint
+                  << "Calibrate_BatchMode" << batchMode
 
                   << "Write_DetectedFeaturePoints" << writePoints
                   << "Write_extrinsicParameters"   << writeExtrinsics
@@ -72,6 +75,7 @@ public:
         node["Calibrate_AssumeZeroTangentialDistortion"] >> calibZeroTangentDist;
         node["Calibrate_FixPrincipalPointAtTheCenter"] >> calibFixPrincipalPoint;
         node["Calibrate_UseFisheyeModel"] >> useFisheye;
+        node["Calibrate_BatchMode"] >> batchMode;
         node["Input_FlipAroundHorizontalAxis"] >> flipVertical;
         node["Show_UndistortedImage"] >> showUndistorsed;
         node["Input"] >> input;
@@ -223,6 +227,7 @@ public:
     bool showUndistorsed;        // Show undistorted images after calibration
     string input;                // The input ->
     bool useFisheye;             // use fisheye camera model for calibration
+    bool batchMode;              // process an image list in parallel, without interaction
     bool fixK1;                  // fix K1 distortion coefficient
     bool fixK2;                  // fix K2 distortion coefficient
     bool fixK3;                  // fix K3 distortion coefficient
@@ -255,6 +260,8 @@ enum { DETECTION = 0, CAPTURING = 1, CALIBRATED = 2 };
 
 bool runCalibrationAndSave(Settings& s, Size imageSize, Mat&  cameraMatrix, Mat& distCoeffs,
                            vector<vector<Point2f> > imagePoints );
+static bool findPattern(const Settings& s, const Mat& view, vector<Point2f>& pointBuf);
+static bool findPatternsBatch(const Settings& s, Size& imageSize, vector<vector<Point2f> >& imagePoints);
 
 int main(int argc, char* argv[])
 {
@@ -290,8 +297,21 @@ int main(int argc, char* argv[])
     const Scalar RED(0,0,255), GREEN(0,255,0);
     const char ESC_KEY = 27;
 
+    //! [batch]
+    const bool batch = s.batchMode && s.inputType == Settings::IMAGE_LIST;
+    if( batch )
+    {
+        if( !findPatternsBatch(s, imageSize, imagePoints) )
+        {
+            cout << "Calibration pattern not found in the image list. Application stopping." << endl;
+            return -1;
+        }
+        runCalibrationAndSave(s, imageSize,  cameraMatrix, distCoeffs, imagePoints);
+    }
+    //! [batch]
+
     //! [get_input]
-    for(;;)
+    while( !batch )
     {
         Mat view;
         bool blinkOutput = false;
@@ -318,46 +338,12 @@ int main(int argc, char* argv[])
         imageSize = view.size();  // Format input image.
         if( s.flipVertical )    flip( view, view, 0 );
 
-        //! [find_pattern]
         vector<Point2f> pointBuf;
 
-        bool found;
-
-        int chessBoardFlags = CALIB_CB_ADAPTIVE_THRESH | CALIB_CB_NORMALIZE_IMAGE;
-
-        if(!s.useFisheye) {
-            // fast check erroneously fails with high distortions like fisheye
-            chessBoardFlags |= CALIB_CB_FAST_CHECK;
-        }
-
-        switch( s.calibrationPattern ) // Find feature points on the input format
-        {
-        case Settings::CHESSBOARD:
-            found = findChessboardCorners( view, s.boardSize, pointBuf, chessBoardFlags);
-            break;
-        case Settings::CIRCLES_GRID:
-            found = findCirclesGrid( view, s.boardSize, pointBuf );
-            break;
-        case Settings::ASYMMETRIC_CIRCLES_GRID:
-            found = findCirclesGrid( view, s.boardSize, pointBuf, CALIB_CB_ASYMMETRIC_GRID );
-            break;
-        default:
-            found = false;
-            break;
-        }
-        //! [find_pattern]
+        bool found = findPattern(s, view, pointBuf);
         //! [pattern_found]
         if ( found)                // If done with success,
         {
-              // improve the found corners' coordinate accuracy for chessboard
-                if( s.calibrationPattern == Settings::CHESSBOARD)
-                {
-                    Mat viewGray;
-                    cvtColor(view, viewGray, COLOR_BGR2GRAY);
-                    cornerSubPix( viewGray, pointBuf, Size(11,11),
-                        Size(-1,-1), TermCriteria( TermCriteria::EPS+TermCriteria::COUNT, 30, 0.1 ));
-                }
-
                 if( mode == CAPTURING &&  // For camera only take new samples after delay time
                     (!s.inputCapture.isOpened() || clock() - prevTimestamp > s.delay*1e-3*CLOCKS_PER_SEC) )
                 {
@@ -467,28 +453,38 @@ static double computeReprojectionErrors( const vector<vector<Point3f> >& objectP
                                          const Mat& cameraMatrix , const Mat& distCoeffs,
                                          vector<float>& perViewErrors, bool fisheye)
 {
-    vector<Point2f> imagePoints2;
-    size_t totalPoints = 0;
-    double totalErr = 0, err;
+    // views are independent: project them in parallel, then reduce in order
+    vector<double> sqErrors(objectPoints.size());
     perViewErrors.resize(objectPoints.size());
 
-    for(size_t i = 0; i < objectPoints.size(); ++i )
+    parallel_for_(Range(0, (int)objectPoints.size()), [&](const Range& range)
     {
-        if (fisheye)
-        {
-            fisheye::projectPoints(objectPoints[i], imagePoints2, rvecs[i], tvecs[i], cameraMatrix,
-                                   distCoeffs);
-        }
-        else
+        vector<Point2f> imagePoints2;
+        for(int i = range.start; i < range.end; ++i )
         {
-            projectPoints(objectPoints[i], rvecs[i], tvecs[i], cameraMatrix, distCoeffs, imagePoints2);
+            if (fisheye)
+            {
+                fisheye::projectPoints(objectPoints[i], imagePoints2, rvecs[i], tvecs[i], cameraMatrix,
+                                       distCoeffs);
+            }
+            else
+            {
+                projectPoints(objectPoints[i], rvecs[i], tvecs[i], cameraMatrix, distCoeffs, imagePoints2);
+            }
+            double err = norm(imagePoints[i], imagePoints2, NORM_L2);
+
+            size_t n = objectPoints[i].size();
+            perViewErrors[i] = (float) std::sqrt(err*err/n);
+            sqErrors[i]      = err*err;
         }
-        err = norm(imagePoints[i], imagePoints2, NORM_L2);
+    });
 
-        size_t n = objectPoints[i].size();
-        perViewErrors[i] = (float) std::sqrt(err*err/n);
-        totalErr        += err*err;
-        totalPoints     += n;
+    size_t totalPoints = 0;
+    double totalErr = 0;
+    for(size_t i = 0; i < objectPoints.size(); ++i )
+    {
+        totalErr    += sqErrors[i];
+        totalPoints += objectPoints[i].size();
     }
 
     return std::sqrt(totalErr/totalPoints);
@@ -541,6 +537,7 @@ static bool runCalibration( Settings& s, Size& imageSize, Mat& cameraMatrix, Mat
 
     //Find intrinsic and extrinsic camera parameters
     double rms;
+    int64 t0 = getTickCount();
 
     if (s.useFisheye) {
         Mat _rvecs, _tvecs;
@@ -559,11 +556,15 @@ static bool runCalibration( Settings& s, Size& imageSize, Mat& cameraMatrix, Mat
     }
 
     cout << "Re-projection error reported by calibrateCamera: "<< rms << endl;
+    cout << "Calibration time: " << (getTickCount() - t0) * 1000. / getTickFrequency() << " ms" << endl;
 
     bool ok = checkRange(cameraMatrix) && checkRange(distCoeffs);
 
+    t0 = getTickCount();
     totalAvgErr = computeReprojectionErrors(objectPoints, imagePoints, rvecs, tvecs, cameraMatrix,
                                             distCoeffs, reprojErrs, s.useFisheye);
+    cout << "Re-projection errors time: " << (getTickCount() - t0) * 1000. / getTickFrequency() << " ms"
+         << endl;
 
     return ok;
 }
@@ -700,3 +701,91 @@ bool runCalibrationAndSave(Settings& s, Size imageSize, Mat& cameraMatrix, Mat&
     return ok;
 }
 //! [run_and_save]
+
+//! [find_pattern]
+// Finds the calibration pattern in a view (refined to sub-pixel accuracy for chessboards)
+static bool findPattern(const Settings& s, const Mat& view, vector<Point2f>& pointBuf)
+{
+    bool found;
+
+    int chessBoardFlags = CALIB_CB_ADAPTIVE_THRESH | CALIB_CB_NORMALIZE_IMAGE;
+
+    if(!s.useFisheye) {
+        // fast check erroneously fails with high distortions like fisheye
+        chessBoardFlags |= CALIB_CB_FAST_CHECK;
+    }
+
+    switch( s.calibrationPattern ) // Find feature points on the input format
+    {
+    case Settings::CHESSBOARD:
+        found = findChessboardCorners( view, s.boardSize, pointBuf, chessBoardFlags);
+        break;
+    case Settings::CIRCLES_GRID:
+        found = findCirclesGrid( view, s.boardSize, pointBuf );
+        break;
+    case Settings::ASYMMETRIC_CIRCLES_GRID:
+        found = findCirclesGrid( view, s.boardSize, pointBuf, CALIB_CB_ASYMMETRIC_GRID );
+        break;
+    default:
+        found = false;
+        break;
+    }
+
+    // improve the found corners' coordinate accuracy for chessboard
+    if( found && s.calibrationPattern == Settings::CHESSBOARD)
+    {
+        Mat viewGray;
+        cvtColor(view, viewGray, COLOR_BGR2GRAY);
+        cornerSubPix( viewGray, pointBuf, Size(11,11),
+            Size(-1,-1), TermCriteria( TermCriteria::EPS+TermCriteria::COUNT, 30, 0.1 ));
+    }
+    return found;
+}
+//! [find_pattern]
+
+//! [batch]
+// Loads the image list and finds the pattern in every image on the OpenCV thread pool.
+// The first nrFrames views with the pattern are kept, in list order, as the
+// interactive mode does.
+static bool findPatternsBatch(const Settings& s, Size& imageSize, vector<vector<Point2f> >& imagePoints)
+{
+    const int nImages = (int)s.imageList.size();
+    vector<vector<Point2f> > viewPoints(nImages);
+    vector<Size> viewSizes(nImages);
+    vector<uchar> found(nImages, 0);
+
+    int64 t0 = getTickCount();
+    parallel_for_(Range(0, nImages), [&](const Range& range)
+    {
+        for(int i = range.start; i < range.end; ++i )
+        {
+            Mat view = imread(s.imageList[i], IMREAD_COLOR);
+            if( view.empty() )
+                continue;
+            if( s.flipVertical )    flip( view, view, 0 );
+            viewSizes[i] = view.size();
+            found[i] = findPattern(s, view, viewPoints[i]);
+        }
+    });
+    const double detectionMs = (getTickCount() - t0) * 1000. / getTickFrequency();
+
+    imagePoints.clear();
+    for(int i = 0; i < nImages && imagePoints.size() < (size_t)s.nrFrames; ++i )
+    {
+        if( !found[i] )
+            continue;
+        if( imagePoints.empty() )
+            imageSize = viewSizes[i];
+        else if( viewSizes[i] != imageSize )
+        {
+            cerr << "Skipping " << s.imageList[i] << ": different image size" << endl;
+            continue;
+        }
+        imagePoints.push_back(viewPoints[i]);
+    }
+
+    cout << "Pattern detection: found in " << countNonZero(found) << "/" << nImages << " images in "
+         << detectionMs << " ms (" << getNumThreads() << " threads)" << endl;
+    return !imagePoints.empty();
+}
+//! [batch]
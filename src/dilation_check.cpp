@@ -0,0 +1,150 @@
+/** \file dilation_check.cpp
+ * @brief Checks the Morphology and RLE dilations against cv::dilate and times them.
+ *
+ * Every image of a folder (the arena images by default) is thresholded with
+ * the default obstacle (red) ranges of the HSV panel and dilated with square
+ * and disk kernels of growing size, up to the 100+ pixels of the robot
+ * inflation at the arena scale. The disk reference is cv::dilate with a
+ * kernel holding the pixels within the radius. A noise image checks the grey
+ * level case of Morphology::dilateRect too.
+ * Results must be identical pixel by pixel: the exit code is 1 otherwise.
+ *
+ * Usage: dilation_check [image folder -- default calibration/arena_images] [repetitions -- default 5]
+ *
+ * Date: 19/10/2026
+*/
+#include "morphology.hpp"
+#include "rle_mask.hpp"
+
+#include "opencv2/core.hpp"
+#include "opencv2/imgcodecs.hpp"
+#include "opencv2/imgproc.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <experimental/filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+const vector<int> KERNEL_SIZES = {3, 15, 31, 61, 101, 151, 201};   ///< Square kernel sides (px).
+
+/** Median of a list of durations.
+ * @param times durations (ms), reordered
+ * @return the median
+*/
+double median(vector<double>& times) {
+    nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+    return times[times.size() / 2];
+}
+
+/** Disk structuring element: the pixels within a radius of the center.
+ * @param radius disk radius in pixels
+ * @return the kernel
+*/
+cv::Mat diskKernel(float radius) {
+    const int r = static_cast<int>(radius);
+    cv::Mat kernel = cv::Mat::zeros(2 * r + 1, 2 * r + 1, CV_8UC1);
+    for (int dy = -r; dy <= r; ++dy)
+        for (int dx = -r; dx <= r; ++dx)
+            if (dx * dx + dy * dy <= radius * radius)
+                kernel.ptr<uchar>(dy + r)[dx + r] = 1;
+    return kernel;
+}
+
+/** Counts the pixels that differ between two images.
+ * @param a first image
+ * @param b second image
+ * @return the number of different pixels
+*/
+int mismatches(const cv::Mat& a, const cv::Mat& b) {
+    cv::Mat diff;
+    cv::compare(a, b, diff, cv::CMP_NE);
+    return cv::countNonZero(diff);
+}
+
+/** Compares the dilations of an image with cv::dilate and times them.
+ * @param mask 8-bit single channel image
+ * @param name image name, for the report
+ * @param repetitions runs timed for each method
+ * @param binary the image is a binary mask (the RLE and disk dilations are checked too)
+ * @return true if the results are identical for every kernel size
+*/
+bool check(const cv::Mat& mask, const string& name, int repetitions, bool binary) {
+    bool same = true;
+    const RLE::Mask runs = binary ? RLE::encode(mask) : RLE::Mask();
+    const cv::Rect frame(cv::Point(0, 0), mask.size());
+    for (int k : KERNEL_SIZES) {
+        const cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(k, k));
+        cv::Mat reference, result, rleResult;
+        RLE::Mask rleMask;
+        vector<double> cvTimes, rectTimes, rleTimes;
+        for (int r = 0; r < repetitions; ++r) {
+            auto start = chrono::steady_clock::now();
+            cv::dilate(mask, reference, kernel);
+            auto mid = chrono::steady_clock::now();
+            Morphology::dilateRect(mask, result, cv::Size(k, k));
+            auto end = chrono::steady_clock::now();
+            if (binary)
+                rleMask = RLE::dilateRect(runs, cv::Size(k, k));
+            auto rleEnd = chrono::steady_clock::now();
+            cvTimes.push_back(chrono::duration<double, milli>(mid - start).count());
+            rectTimes.push_back(chrono::duration<double, milli>(end - mid).count());
+            rleTimes.push_back(chrono::duration<double, milli>(rleEnd - end).count());
+        }
+        int rectMismatches = mismatches(result, reference);
+        int diskMismatches = 0;
+        if (binary) {
+            rleMask.rasterize(frame, rleResult);
+            rectMismatches += mismatches(rleResult, reference);
+
+            const float radius = k / 2.0f;
+            cv::Mat diskReference, diskResult;
+            cv::dilate(mask, diskReference, diskKernel(radius));
+            Morphology::dilateDisk(mask, diskResult, radius);
+            diskMismatches = mismatches(diskResult, diskReference);
+            RLE::dilateDisk(runs, radius).rasterize(frame, diskResult);
+            diskMismatches += mismatches(diskResult, diskReference);
+        }
+        same = same && (rectMismatches == 0) && (diskMismatches == 0);
+        printf("%-12s %4dx%-4d kernel %3d: cv::dilate %8.3f ms, dilateRect %8.3f ms, RLE::dilateRect %8.3f ms, "
+               "mismatches %d (rect) %d (disk)\n",
+               name.c_str(), mask.cols, mask.rows, k, median(cvTimes), median(rectTimes),
+               binary ? median(rleTimes) : 0.0, rectMismatches, diskMismatches);
+    }
+    return same;
+}
+
+int main(int argc, char** argv) {
+    const string folder = (argc > 1) ? argv[1] : "calibration/arena_images";
+    const int repetitions = (argc > 2) ? max(1, stoi(argv[2])) : 5;
+
+    vector<string> files;
+    for (const auto& entry : experimental::filesystem::directory_iterator(folder))
+        files.push_back(entry.path().string());
+    sort(files.begin(), files.end());
+
+    bool same = true;
+    size_t images = 0;
+    for (const string& file : files) {
+        const cv::Mat img = cv::imread(file);
+        if (img.empty())
+            continue;
+        cv::Mat hsv, low, high, mask;
+        cv::cvtColor(img, hsv, cv::COLOR_BGR2HSV);
+        cv::inRange(hsv, cv::Scalar(0, 100, 100), cv::Scalar(10, 255, 255), low);
+        cv::inRange(hsv, cv::Scalar(160, 100, 100), cv::Scalar(180, 255, 255), high);
+        cv::bitwise_or(low, high, mask);
+        same = check(mask, experimental::filesystem::path(file).filename().string(), repetitions, true) && same;
+        ++images;
+    }
+
+    cv::Mat noise(600, 800, CV_8UC1);
+    cv::randu(noise, 0, 256);
+    same = check(noise, "noise", repetitions, false) && same;
+
+    cout << images << " images: " << (same ? "identical" : "MISMATCH") << endl;
+    return same ? 0 : 1;
+}
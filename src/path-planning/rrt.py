@@ -14,8 +14,10 @@ parser = argparse.ArgumentParser()
 
 parser.add_argument("-in",help="input file (default: input.txt)",default="input.txt")
 parser.add_argument("-out",help="output file (default: output.txt)",default="output.txt")
+parser.add_argument("-seed",help="random seed (default: system time)",type=int,default=None)
 
 args = vars(parser.parse_args())
+seed(args['seed']);
 
 # Check for empty lines
 file_handler = open(args['in'],"r");
@@ -0,0 +1,106 @@
+# Persistent RRT planner worker
+# Same algorithm as rrt.py, but started once: planning problems are read from
+# stdin and the paths are written to stdout as binary frames of
+# little-endian int32 values (see include/planner_worker.hpp).
+#
+# Request:  borders (count, x, y, ...), obstacle count, obstacles (count, x, y, ...),
+#           source x, source y, destination x, destination y
+# Response: path point count (-1 if no path is found), x, y, ...
+
+from random import *
+from helpers.graph import *
+from helpers.geometry import *
+import argparse
+import struct
+import sys
+
+MAGIC = 0x57545252;	# "RRTW", written once at startup
+step_size = 5;
+bias_prob = 0.05;
+max_vertices = 3000;
+
+parser = argparse.ArgumentParser()
+
+parser.add_argument("-seed",help="random seed (default: system time)",type=int,default=None)
+
+args = vars(parser.parse_args())
+seed(args['seed']);
+
+
+# Read exactly n int32 values---------------------------------------------------
+def read_ints(stream, n):
+	data = b"";
+	while len(data) < 4*n:
+		chunk = stream.read(4*n - len(data));
+		if not chunk:
+			raise EOFError;
+		data += chunk;
+	return struct.unpack("<%di" % n, data);
+
+def read_points(stream):
+	count = read_ints(stream, 1)[0];
+	values = read_ints(stream, 2*count);
+	return [(values[2*i], values[2*i+1]) for i in range(count)];
+
+
+# Find a path with RRT, None if the vertex limit is reached---------------------
+def find_path(boundary, obstacles, source, dest):
+	graph_vertices = [source];
+	graph = [[]];
+
+	while len(graph_vertices) < max_vertices:
+		if(uniform(0,1) < bias_prob):
+			potential_next_vertex = dest;
+		else:
+			potential_next_vertex = random_point([boundary[0].x, boundary[1].x], [boundary[0].y, boundary[2].y]);
+		if(potential_next_vertex.inside_polygon(obstacles) is True):
+			continue;
+
+		vertex_index = potential_next_vertex.find_closest_point(graph_vertices);
+		if(graph_vertices[vertex_index].equals(potential_next_vertex)):
+			continue;
+
+		potential_next_vertex = step_from_to(graph_vertices[vertex_index], potential_next_vertex, step_size);
+		if(potential_next_vertex.inside_polygon(obstacles) is True):
+			continue;
+		if(check_obstruction(obstacles, [potential_next_vertex, graph_vertices[vertex_index]]) is False):
+			continue;
+
+		graph_vertices.append(potential_next_vertex);
+		graph.append([vertex_index]);
+		n = len(graph_vertices)-1;
+		graph[vertex_index].append(n);
+
+		if(check_obstruction(obstacles,[dest, potential_next_vertex]) is True):
+			graph_vertices.append(dest);
+			graph.append([n]);
+			graph[n].append(n+1);
+			return [graph_vertices[i] for i in bfs(graph, 0, n+1)];
+	return None;
+
+
+# Serve the requests until stdin is closed--------------------------------------
+stdin = getattr(sys.stdin, "buffer", sys.stdin);
+stdout = getattr(sys.stdout, "buffer", sys.stdout);
+stdout.write(struct.pack("<i", MAGIC));
+stdout.flush();
+
+while True:
+	try:
+		boundary = [point(p[0], p[1]) for p in read_points(stdin)];
+		obstacles = [];
+		for index in range(read_ints(stdin, 1)[0]):
+			obstacles.append([point(p[0], p[1], index) for p in read_points(stdin)]);
+		ends = read_ints(stdin, 4);
+	except EOFError:
+		break;
+
+	path = find_path(boundary, obstacles, point(ends[0], ends[1]), point(ends[2], ends[3]));
+	if path is None:
+		stdout.write(struct.pack("<i", -1));
+	else:
+		values = [len(path)];
+		for p in path:
+			values += [int(p.x), int(p.y)];
+		stdout.write(struct.pack("<%di" % len(values), *values));
+	stdout.flush();
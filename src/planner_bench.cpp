@@ -0,0 +1,218 @@
+/** \file planner_bench.cpp
+ * @brief Compares the native point planners with the rrt.py script on a planning problem.
+ *
+ * The problem is read from a file in the rrt.py input format (borders on the
+ * first line, one inflated obstacle per line, start and goal on the last
+ * line, coordinates in millimeters). Every planner solves it once per seed
+ * on the same obstacles: the native backends share one collision checker,
+ * as in buildPointPlanner, and are built for every run, so their times
+ * include the roadmap construction. The script is started as the student
+ * interface does, so its times include the interpreter startup. Latency
+ * percentiles, failures, path length and, for the tree planners,
+ * iterations are printed.
+ *
+ * The default problem is a wall crossed by a 2 cm wide and 30 cm long
+ * corridor, where the single tree of rrt.py needs most of its vertices.
+ *
+ * Usage: planner_bench [problem -- default src/path-planning/narrow_gap.txt] [runs -- default 50] [python -- default python]
+ *
+ * Date: 19/10/2026
+*/
+#include "utils.hpp"
+#include "clipper_helper.hpp"
+#include "collision_checker.hpp"
+#include "point_planner.hpp"
+#include "prm.hpp"
+#include "process_utils.hpp"
+#include "rrt_connect.hpp"
+#include "rrt_star.hpp"
+#include "vertical_cell_decomposition.hpp"
+#include "visibility_graph.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+const float SCALE = 1000;       ///< rrt.py coordinates per meter.
+const string SCRIPT = "src/path-planning/rrt.py";   ///< Planner script, from the repository root.
+const float VERTEX_MARGIN = 0.005f;     ///< Visibility graph vertex margin (VISIBILITY_VERTEX_MARGIN).
+
+/** Parses a line of points "(x,y),(x,y),...".
+ * @param line input line
+ * @return the points, in meters
+*/
+vector<Point> parsePoints(const string& line) {
+    vector<Point> points;
+    string clean;
+    for (char c : line)
+        clean += ((c == '(') || (c == ')') || (c == ',')) ? ' ' : c;
+    istringstream values(clean);
+    float x, y;
+    while (values >> x >> y)
+        points.emplace_back(x / SCALE, y / SCALE);
+    return points;
+}
+
+/** Percentile of a sorted list.
+ * @param values sorted values
+ * @param p percentile (0-1)
+ * @return the value
+*/
+double percentile(const vector<double>& values, double p) {
+    return values[min(values.size() - 1, size_t(p * values.size()))];
+}
+
+/** Prints the summary of a planner.
+ * @param name planner name
+ * @param times latency of every run (ms), reordered
+ * @param failures runs without a path
+ * @param lengths path length of every successful run (m), reordered
+ * @param iterations iterations of every run, reordered (empty if not reported)
+*/
+void report(const string& name, vector<double>& times, int failures,
+            vector<double>& lengths, vector<double>& iterations) {
+    sort(times.begin(), times.end());
+    sort(lengths.begin(), lengths.end());
+    sort(iterations.begin(), iterations.end());
+    printf("%-28s p50 %9.2f ms, p90 %9.2f ms, p99 %9.2f ms, max %9.2f ms, failures %d/%zu",
+           name.c_str(), percentile(times, 0.5), percentile(times, 0.9), percentile(times, 0.99),
+           times.back(), failures, times.size());
+    if (!lengths.empty())
+        printf(", length p50 %.3f m", percentile(lengths, 0.5));
+    if (!iterations.empty())
+        printf(", iterations p50 %.0f p99 %.0f", percentile(iterations, 0.5), percentile(iterations, 0.99));
+    printf("\n");
+}
+
+/** Length of a path.
+ * @param path path points
+ * @return the length (m)
+*/
+double pathLength(const vector<Point>& path) {
+    double length = 0;
+    for (size_t i = 1; i < path.size(); ++i)
+        length += Planning::distance(path[i-1], path[i]);
+    return length;
+}
+
+int main(int argc, char** argv) {
+    const string problem = (argc > 1) ? argv[1] : "src/path-planning/narrow_gap.txt";
+    const int runs = (argc > 2) ? max(1, stoi(argv[2])) : 50;
+    const string python = (argc > 3) ? argv[3] : "python";
+
+    ifstream input(problem);
+    if (!input.is_open())
+        throw runtime_error("Cannot read file: " + problem);
+    vector<string> lines;
+    for (string line; getline(input, line);)
+        if (line.find('(') != string::npos)
+            lines.push_back(line);
+    if (lines.size() < 2)
+        throw runtime_error("Bad problem file: " + problem);
+    const Polygon borders = parsePoints(lines.front());
+    vector<Polygon> obstacles;
+    for (size_t i = 1; i + 1 < lines.size(); ++i)
+        obstacles.push_back(parsePoints(lines[i]));
+    const vector<Point> endpoints = parsePoints(lines.back());
+    const Planning::CollisionChecker checker(borders, obstacles);
+
+    // native backends, on the checker of buildPointPlanner
+    vector<Point> vertices;
+    for (const Polygon& p : ClipperHelper::inflatePolygons(obstacles, VERTEX_MARGIN))
+        vertices.insert(vertices.end(), p.begin(), p.end());
+    const Polygon innerBorders = ClipperHelper::offsetBorders(borders, -VERTEX_MARGIN);
+    vertices.insert(vertices.end(), innerBorders.begin(), innerBorders.end());
+
+    typedef function<unique_ptr<Planning::PointPlanner>(uint32_t)> Factory;
+    const vector<Factory> backends = {
+        [&](uint32_t) { return unique_ptr<Planning::PointPlanner>(new Planning::VisibilityGraph(checker, vertices)); },
+        [&](uint32_t) { return unique_ptr<Planning::PointPlanner>(new Planning::VerticalCellDecomposition(checker)); },
+        [&](uint32_t seed) {
+            Planning::ProbabilisticRoadmap::Parameters parameters;
+            parameters.seed = seed;
+            unique_ptr<Planning::ProbabilisticRoadmap> roadmap(new Planning::ProbabilisticRoadmap(checker, parameters));
+            roadmap->build();
+            return unique_ptr<Planning::PointPlanner>(move(roadmap));
+        },
+        [&](uint32_t seed) {
+            Planning::InformedRRTStar::Parameters parameters;
+            parameters.seed = seed;
+            return unique_ptr<Planning::PointPlanner>(new Planning::InformedRRTStar(checker, parameters));
+        },
+        [&](uint32_t seed) {
+            Planning::RRTConnect::Parameters parameters;
+            parameters.seed = seed;
+            return unique_ptr<Planning::PointPlanner>(new Planning::RRTConnect(checker, parameters));
+        }
+    };
+
+    vector<double> times, lengths, iterations;
+    int failures;
+    for (const Factory& backend : backends) {
+        times.clear();
+        lengths.clear();
+        iterations.clear();
+        failures = 0;
+        string name;
+        for (int seed = 1; seed <= runs; ++seed) {
+            auto start = chrono::steady_clock::now();
+            unique_ptr<Planning::PointPlanner> planner = backend(seed);
+            name = planner->name();
+            vector<Point> path;
+            try {
+                path = planner->plan(endpoints[0], endpoints[1]);
+            } catch (const runtime_error&) {
+                path.clear();
+            }
+            times.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+            if (path.empty() || !checker.pathFree(path))
+                ++failures;
+            else
+                lengths.push_back(pathLength(path));
+            if (planner->lastIterations() > 0)
+                iterations.push_back(planner->lastIterations());
+        }
+        report(name, times, failures, lengths, iterations);
+    }
+
+    // rrt.py, a path is found if it ends at the goal
+    times.clear();
+    lengths.clear();
+    iterations.clear();
+    failures = 0;
+    const string output_file = ProcessUtils::temporaryFile("rrt_output_");
+    for (int seed = 1; seed <= runs; ++seed) {
+        auto start = chrono::steady_clock::now();
+        const pid_t pid = ProcessUtils::spawn({python, SCRIPT, "-in", problem, "-out", output_file,
+                                               "-seed", to_string(seed)});
+        int status;
+        while (!ProcessUtils::exited(pid, status))
+            this_thread::sleep_for(chrono::milliseconds(1));
+        times.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+
+        ifstream output(output_file);
+        vector<Point> path;
+        for (string line; getline(output, line);) {
+            const vector<Point> points = parsePoints(line);
+            path.insert(path.end(), points.begin(), points.end());
+        }
+        if ((status != 0) || path.empty() ||
+            (Planning::distance(path.back(), endpoints[1]) > 1 / SCALE))
+            ++failures;
+        else
+            lengths.push_back(pathLength(path));
+    }
+    remove(output_file.c_str());
+    report("rrt.py", times, failures, lengths, iterations);
+    return 0;
+}
@@ -14,15 +14,64 @@
 #include <math.h>
 #include <limits>
 #include <algorithm>
-
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include "camera_pipeline.hpp"
+#include "calibration_cache.hpp"
 #include "clipper_helper.hpp"
+#include "coarse_detection.hpp"
 #include "corner_detection.hpp"
+#include "display_thread.hpp"
+#include "distance_field.hpp"
+#include "dubins_rrt.hpp"
+#include "frame_log.hpp"
+#include "frame_replay.hpp"
+#include "map_cache.hpp"
+#include "morphology.hpp"
+#include "parallel_utils.hpp"
+#include "planner_worker.hpp"
 #include "polygon_utils.hpp"
+#include "prm.hpp"
+#include "process_utils.hpp"
+#include "rectification.hpp"
+#include "rle_mask.hpp"
+#include "rrt_connect.hpp"
+#include "rrt_star.hpp"
+#include "state_lattice.hpp"
+#include "vertical_cell_decomposition.hpp"
+#include "visibility_graph.hpp"
 
 #define AUTO_CORNER_DETECTION true  ///< Use Automatic corner detection
 #define COLOR_TUNING_WIZARD false   ///< Use color tuning panel
 #define DYNAMIC_PROGRAMMING         ///< Use quick Iterative Dynamic Programming solution for Multipoint Markov-Dubins problem
 #define MANUAL_LASTCURVE            ///< Plan manually last segment
+#define FUSED_RECTIFICATION         ///< Undistort and unwarp with a single precomputed remap
+// #define ROBOT_POINT_LOCALIZATION    ///< Localize the robot on the raw frame, rectifying only the triangle vertices
+#define ROBOT_TRACKING              ///< Search the robot only around its last known position
+#define CALIBRATION_CACHE           ///< Reuse the extrinsic calibration while the camera does not move
+#define RLE_MASKS                   ///< Extract obstacles, gate and victims from run-length encoded masks
+#define MAP_CHANGE_DETECTION        ///< Reprocess only the arena regions changed since the last processed map
+#define OVERLAPPED_MAP_PREPROCESSING ///< Build the obstacle-only planning geometry (inflation, visibility graph edges, distance field cells) while victims are recognized (planPath merges in the borders)
+// #define PIPELINED_LOCALIZATION      ///< Rectify and localize the robot on background stage threads
+// #define HEADLESS                    ///< No HighGUI windows nor key handling (production)
+// #define DUBINS_RRT                  ///< Plan the Dubins path directly with a kinodynamic RRT (no smoothing nor multipoint Dubins stage)
+// #define STATE_LATTICE               ///< Plan the Dubins path directly with A* on a state lattice (no smoothing nor multipoint Dubins stage)
+#define DISTANCE_FIELD              ///< Order and prune the mission 2 victims with grid wavefront distances
+#define PLANNER_WORKER              ///< Run the RRT script as a persistent worker process (binary socket protocol) instead of once per segment (comment out to race RRT_RACERS script instances per segment)
+// #define FRAME_LOG_RECORDING         ///< Also append the snapshots (every frame with RECORD_SESSION) to a binary frame log
+
+#if defined(PIPELINED_LOCALIZATION) && !defined(FUSED_RECTIFICATION)
+    #error "PIPELINED_LOCALIZATION requires FUSED_RECTIFICATION"
+#endif
+
+#if defined(ROBOT_POINT_LOCALIZATION) && !defined(FUSED_RECTIFICATION)
+    #error "ROBOT_POINT_LOCALIZATION requires FUSED_RECTIFICATION"
+#endif
 
 // -------------------------------- DEBUG FLAGS --------------------------------
 // - Configuration Debug flags - //
@@ -36,15 +85,21 @@
 
 // - Image Analysis Debug flags - //
 // #define DEBUG_FINDOBSTACLES
+// #define DEBUG_BENCH_DILATION      ///< compare obstacle dilation with cv::dilate on every map (see also dilation_check)
 // #define DEBUG_FINDGATE
 // #define DEBUG_FINDVICTIMS
+// #define DEBUG_MAP_CHANGES         ///< print the changed arena regions and the map update time
+// #define DEBUG_MAP_LATENCY         ///< print map processing phases and the time until the obstacle geometry is ready
 // #define DEBUG_FINDROBOT
+// #define DEBUG_POINT_LOCALIZATION  ///< compare point-level and full-frame robot localization
+// #define DEBUG_PIPELINE            ///< print localization pipeline latencies and dropped frames
 
 // - Planning Debug flags - //
 #define DEBUG_PLANPATH            ///< generic info about the whole planner
 // #define DEBUG_COMPUTEARRIVAL
 // #define DEBUG_PLANPATH_SEGMENTS   ///< show images with the goals of every planned segment
 // #define DEBUG_RRT                 ///< inner planning algorithm
+// #define DEBUG_BENCH_PLANNERS      ///< compare the native point planners on every planned segment
 // #define DEBUG_PATH_SMOOTHING      ///< path smoothing pipeline
 // #define DEBUG_DRAWCURVE           ///< dubins path plotting
 #define DEBUG_SCORES              ///< track times and scores of victims to collect
@@ -56,6 +111,8 @@ using matrix = std::vector<std::vector<float>>;
 
 enum class Mission { mission1, mission2 }; ///< Planning tasks available.
 
+enum class PlannerBackend { rrt, visibilityGraph, cellDecomposition, prm, rrtStar, rrtConnect }; ///< Point planners available.
+
 // --------------------------------- GLOBAL VARIABLES ---------------------------------
 Mission mission = Mission::mission2;   ///< Planning task chosen.
 
@@ -126,6 +183,149 @@ const double PATH_RESOLUTION = 0.01;  ///< Path resolution (sampling).
 
 const float ROBOT_SPEED = 0.1f;       ///< Robot speed: 0.1 m/s.
 
+//Calibration
+const string CALIBRATION_CACHE_FILE = "/extrinsic_cache.yml"; ///< Cached extrinsic calibration.
+const string CALIBRATION_REMAP_FILE = "/extrinsic_cache_remap.bin"; ///< Cached fused remap table.
+const int CALIBRATION_CACHE_MAX_DISTANCE = 4; ///< Maximum dHash distance (bits out
+                                              ///< of 64) between the calibration
+                                              ///< frame and a new first frame
+                                              ///< for the cache to be reused.
+const int CALIBRATION_CACHE_CHECK_RADIUS = 16; ///< Half size (pixels) of the windows
+                                              ///< the arena corners are found again in
+                                              ///< before the cache is reused.
+const float CALIBRATION_CACHE_MAX_CORNER_SHIFT = 1.5f; ///< Maximum distance (pixels)
+                                              ///< of a corner found again from its
+                                              ///< position on the calibration frame.
+
+//Image loading
+const size_t LOAD_IMAGE_HOLD = 31;    ///< Calls every loaded image is returned for
+                                      ///< (the first one plus 30 frozen steps).
+const FrameReplay::EndPolicy LOAD_IMAGE_END = FrameReplay::EndPolicy::loop;
+                                      ///< Behaviour at the end of the image list.
+const size_t LOAD_IMAGE_PREFETCH = 4; ///< Images decoded ahead of the replay.
+const string REPLAY_LOG_FILE = "/img_to_load/replay.flog"; ///< Frame log replayed
+                                      ///< by loadImage instead of the jpg
+                                      ///< images, if present.
+
+//Frame recording
+const string FRAME_LOG_FILE = "/image/frames.flog"; ///< Frame log written by
+                                      ///< genericImageListener (FRAME_LOG_RECORDING).
+const FrameLog::Encoding FRAME_LOG_ENCODING = FrameLog::Encoding::raw;
+                                      ///< Frame log payload encoding.
+const bool RECORD_SESSION = false;    ///< Record every frame, not only snapshots.
+const string SNAPSHOT_TOPIC_SUFFIX = "/snapshot"; ///< Topic suffix of the
+                                      ///< frames saved with the S key.
+const string REPLAY_TOPIC_SUFFIX = SNAPSHOT_TOPIC_SUFFIX; ///< Frames of the
+                                      ///< replay log returned by loadImage:
+                                      ///< topics ending with this suffix (the
+                                      ///< camera topic replays the recorded
+                                      ///< session, "" every frame).
+const int DISPLAY_KEY_POLL_MS = 30;   ///< Key polling period of the display thread.
+
+//Image analysis
+const unsigned int VICTIM_RECOGNITION_THREADS = 0;  ///< Threads used for victim
+                                                    ///< digit recognition.
+                                                    ///< 0 uses every available
+                                                    ///< core.
+const int DETECTION_PYRAMID_LEVELS = 0;   ///< Coarse-to-fine detection levels.
+                                          ///< Blobs are located on a frame
+                                          ///< decimated by 2^levels per side
+                                          ///< and analyzed at full resolution
+                                          ///< only inside their ROIs.
+                                          ///< 0 analyzes the whole frame.
+const Morphology::Footprint OBSTACLE_DILATION_SHAPE = Morphology::Footprint::rect;
+                                      ///< Obstacle dilation footprint.
+                                      ///< rect matches the former cv::dilate
+                                      ///< square, disk follows the robot
+                                      ///< radius without over-inflating
+                                      ///< obstacle corners.
+const string MAP_CACHE_FILE = "/map_cache.yml";       ///< Last processed map.
+const string MAP_CACHE_IMAGE_FILE = "/map_cache.png"; ///< Arena image of the
+                                                      ///< last processed map.
+const bool MAP_CACHE_REFRESH = true;  ///< Store the map again after a partial
+                                      ///< update (a full-frame PNG write). false
+                                      ///< keeps the last fully processed map:
+                                      ///< the regions changed since then are
+                                      ///< processed again at every run.
+const int MAP_CHANGE_PIXEL_THRESHOLD = 40;  ///< Channel difference of a changed pixel.
+const int MAP_CHANGE_CELL_SIZE = 16;        ///< Side of the change detection cells (pixels).
+const double MAP_CHANGE_CELL_FRACTION = 0.1; ///< Fraction of changed pixels of
+                                             ///< a changed cell.
+const double MAP_CHANGE_MAX_FRACTION = 0.5; ///< Fraction of the arena above which
+                                            ///< the whole map is processed again.
+const int MAP_CHANGE_MAX_ITERATIONS = 4;    ///< Region growing rounds before
+                                            ///< falling back to the whole map.
+const float ROBOT_MAX_SPEED = 0.3f;   ///< Maximum robot speed (m/s) used to
+                                      ///< size the robot tracking window.
+const float ROBOT_TRACKING_MARGIN = 0.05f; ///< Extra tracking window margin
+                                           ///< (meters), accounts for
+                                           ///< detection noise and for the
+                                           ///< scale difference of raw frames.
+const double ROBOT_TRACKING_MAX_INTERVAL = 1.0; ///< Frame interval (seconds)
+                                                ///< after which the tracked
+                                                ///< pose is considered stale
+                                                ///< and the whole frame is
+                                                ///< searched.
+const uint64_t PIPELINE_MAX_POSE_AGE = 1;  ///< Oldest pose (frames behind the
+                                           ///< last captured one) returned
+                                           ///< by the localization pipeline.
+const int PIPELINE_POSE_TIMEOUT_MS = 33;   ///< Maximum wait (about one frame)
+                                           ///< for a fresh enough pose.
+const uint64_t PIPELINE_STATS_PERIOD = 300; ///< Frames between pipeline
+                                            ///< statistics prints.
+const double POINT_LOCALIZATION_POS_TOLERANCE = 0.01;  ///< Max position difference
+                                                       ///< (meters) between point-level
+                                                       ///< and full-frame localization.
+const double POINT_LOCALIZATION_ANGLE_TOLERANCE = 3.0 * M_PI / 180.0; ///< Max angle
+                                                       ///< difference (radians) between
+                                                       ///< point-level and full-frame
+                                                       ///< localization.
+const PlannerBackend POINT_PLANNER = PlannerBackend::rrt; ///< Planner of
+                                      ///< the point paths between victims
+                                      ///< (smoothed and turned into Dubins
+                                      ///< curves afterwards). The native
+                                      ///< backends are opt-in: compare them
+                                      ///< with DEBUG_BENCH_PLANNERS and
+                                      ///< planner_bench before switching.
+const float VISIBILITY_VERTEX_MARGIN = 0.005f; ///< Distance (m) of the visibility
+                                      ///< graph vertices from the inflated
+                                      ///< obstacles and the borders (keeps them
+                                      ///< strictly in free space).
+const size_t PRM_SAMPLES = 1500;      ///< Free samples of the probabilistic roadmap.
+const size_t PRM_NEIGHBOURS = 10;     ///< Nearest samples every roadmap sample is
+                                      ///< connected to.
+const uint32_t PRM_SEED = 1;          ///< Roadmap sampling seed (fixed for
+                                      ///< reproducible plans).
+const string PRM_CACHE_FILE = "/prm_roadmap.bin"; ///< Roadmap of the last map
+                                      ///< (reused if the map and the roadmap
+                                      ///< parameters did not change).
+const double RRT_STAR_BUDGET = 0.05;  ///< Planning time (seconds) of every
+                                      ///< informed RRT* query: longer budgets
+                                      ///< give shorter paths.
+const float RRT_STAR_STEP = 0.1f;     ///< Maximum informed RRT* edge length (m).
+const float RRT_CONNECT_STEP = 0.05f; ///< Maximum RRT-Connect edge length (m).
+const size_t RRT_CONNECT_MAX_ITERATIONS = 20000; ///< RRT-Connect iterations
+                                      ///< before giving up a query.
+const unsigned int RRT_RACERS = 4;    ///< Differently seeded RRT script instances
+                                      ///< raced on every query, at most one per
+                                      ///< core (1: no racing). Opt-in: racing
+                                      ///< only runs without PLANNER_WORKER.
+const double RRT_RACE_DEADLINE = 0.0; ///< Time (seconds) to wait for shorter RRT
+                                      ///< paths after the first one (0: keep
+                                      ///< the first path found).
+const int RRT_RACE_POLL_MS = 2;       ///< Polling period of the RRT racers.
+const double DUBINS_RRT_STEP = 0.3;   ///< Maximum Dubins RRT edge length (m).
+const size_t DUBINS_RRT_MAX_ITERATIONS = 5000; ///< Dubins RRT iterations
+                                      ///< before giving up a segment.
+const float LATTICE_CELL = 0.02f;     ///< State lattice cell side (m).
+const unsigned int LATTICE_HEADINGS = 16; ///< State lattice headings.
+const double LATTICE_PRIMITIVE_LENGTH = 0.2; ///< Distance reached by every
+                                      ///< lattice motion primitive (m).
+const size_t LATTICE_MAX_EXPANSIONS = 20000; ///< Expanded lattice states
+                                      ///< before giving up a segment.
+const float DISTANCE_FIELD_CELL = 0.01f; ///< Cell side of the wavefront
+                                      ///< distance fields (m).
+
 //! Main namespace containing student interface methods
 namespace student {
 
@@ -145,56 +345,167 @@ struct Color_config {
 /** Image used for debug drawing. */
 cv::Mat dcImg = cv::Mat(600, 800, CV_8UC3, cv::Scalar(255,255,255));
 
+/** Cached undistortion and rectification remap tables. */
+Rectification::RemapCache rectification;
+
+/** Extrinsic calibration of this run (CALIBRATION_CACHE). */
+CalibrationCache::Entry calibration;
+bool calibrationFromCache = false;  ///< True if calibration was loaded from disk.
+
+/** Last known robot triangle, used to restrict the robot search window. */
+struct RobotTracker {
+    bool valid = false;         ///< True if the last search found the robot.
+    cv::Point2f center;         ///< Triangle baricenter (pixels).
+    float radius = 0;           ///< Triangle circumradius (pixels).
+    chrono::steady_clock::time_point stamp; ///< Time of the last detection.
+};
+
+RobotTracker rectifiedTracker;  ///< Tracker for rectified frames (findRobot).
+RobotTracker rawTracker;        ///< Tracker for raw frames (findRobotRaw).
+
+/** Frame travelling through the localization pipeline. */
+struct LocalizationFrame {
+    cv::Mat image;              ///< Raw frame (rectified by the first stage).
+    vector<cv::Point> curve;    ///< Robot triangle vertices (pixels).
+    Polygon triangle;           ///< Robot triangle (meters).
+    double x = 0;               ///< Robot position x coordinate.
+    double y = 0;               ///< Robot position y coordinate.
+    double theta = 0;           ///< Robot angle.
+};
+
+/** Localization pipeline, started after the first synchronous localization
+ * (PIPELINED_LOCALIZATION).
+*/
+unique_ptr<CameraPipeline::Pipeline<LocalizationFrame>> localizationPipeline;
+
+/** True once the arena map has been processed.
+ * From then on frames are only used for robot localization.
+*/
+bool mapProcessed = false;
+
+/** Planning geometry that depends on the obstacles only.
+ * It is computed once per map (see prepareObstacleGeometry) instead of once
+ * per planner call. Roadmaps and distance fields also depend on the arena
+ * borders, which are known only in planPath: only their obstacle parts are
+ * here, the borders are merged in by the planner.
+*/
+struct ObstacleGeometry {
+    vector<Polygon> obstacles;  ///< Obstacles the geometry was computed from.
+    vector<Polygon> inflated;   ///< Obstacles inflated by SAFETY_INFLATE_AMOUNT.
+    shared_ptr<const Planning::ObstacleVisibility> visibility; ///< Visibility graph
+                                ///< vertices around the inflated obstacles and
+                                ///< their edges (visibility graph POINT_PLANNER only).
+    shared_ptr<const Planning::ObstacleRaster> fieldRaster; ///< Obstacle cells of
+                                ///< the victim distance fields (DISTANCE_FIELD only).
+};
+
+/** Obstacle geometry of the current map, possibly still being computed. */
+shared_future<ObstacleGeometry> obstacleGeometry;
+mutex obstacleGeometryMutex;    ///< Protects obstacleGeometry.
+
+/** Native point planner of a map, built on the first query (see mapPlannerFor). */
+struct MapPlanner {
+    Polygon borders;                            ///< Borders the planner was built for.
+    vector<Polygon> obstacles;                  ///< Obstacles the planner was built for.
+    unique_ptr<Planning::PointPlanner> planner; ///< Planner chosen by POINT_PLANNER.
+};
+
+MapPlanner mapPlanner;      ///< Point planner of the current map.
+
+/** State lattice of a map, built on the first query (see mapLatticeFor). */
+struct MapLattice {
+    Polygon borders;                            ///< Borders the lattice was built for.
+    vector<Polygon> obstacles;                  ///< Obstacles the lattice was built for.
+    unique_ptr<Planning::StateLattice> lattice; ///< Lattice with its blocked cells and primitives.
+};
+
+MapLattice mapLattice;      ///< State lattice of the current map.
+
+shared_ptr<PlannerWorker> plannerWorker;    ///< RRT worker process, started on the first query (see plannerWorkerFor).
+mutex plannerWorkerMutex;                   ///< Protects plannerWorker.
+
+/** Shows a debug image and waits for a key press.
+ * The display thread is paused meanwhile (see Display::GuiLock).
+ * @param window window name
+ * @param img image to show
+*/
+void showDebugImage(const string& window, const cv::Mat& img) {
+    Display::GuiLock gui;
+    cv::imshow(window, img);
+    cv::waitKey(0);
+}
+
 /** Loads images from the file system.
+ * If config_folder/img_to_load/replay.flog exists, the frames of that log
+ * whose topic ends with REPLAY_TOPIC_SUFFIX are replayed straight from the
+ * memory-mapped file (see FrameLog::Reader).
+ * Otherwise the images in config_folder/img_to_load/ are replayed in order,
+ * decoded ahead of time by a background thread (see
+ * FrameReplay::FrameReplayer), so no call waits for a decode.
+ * Every image is returned for LOAD_IMAGE_HOLD calls.
  * @param img_out Output image.
  * @param config_folder Configuration folder path.
- * @param initialized True if images were found.
- * @param img_list  List of images to load.
- * @param idx Index of the current image.
- * @param function_call_counter Iterations count.
- * @param freeze_img_n_step Hold the current image for this number of iterations.
- * @param current_img Store the image for a period, avoid to load it from file every time.
 */
 void loadImage(cv::Mat& img_out, const string& config_folder) {
-    static bool initialized = false;
-    static vector<cv::String> img_list;
-    static size_t idx = 0;
-    static size_t function_call_counter = 0;
-    const static size_t freeze_img_n_step = 30;
-    static cv::Mat current_img;
-
-    if (!initialized) {
-        const bool recursive = false;
-        // Load the list of jpg image contained in the config_folder/img_to_load/
-        cv::glob(config_folder + "/img_to_load/*.jpg", img_list, recursive);
-
-        if (img_list.size() > 0) {
-            initialized = true;
-            idx = 0;
-            current_img = cv::imread(img_list[idx]);
-            function_call_counter = 0;
+    static unique_ptr<FrameReplay::FrameReplayer> replayer;
+    static unique_ptr<FrameLog::Reader> log_reader;
+    static vector<size_t> log_frames;   // frames of the log with the replayed topic
+    static size_t log_idx = 0;
+    static size_t log_calls = 0;
+
+    if (!replayer && !log_reader) {
+        const string log_path = config_folder + REPLAY_LOG_FILE;
+        if (experimental::filesystem::exists(log_path)) {
+            log_reader.reset(new FrameLog::Reader(log_path));
+            for (size_t i = 0; i < log_reader->count(); ++i) {
+                const string topic = log_reader->topic(i);
+                if ((topic.size() >= REPLAY_TOPIC_SUFFIX.size()) &&
+                    (topic.compare(topic.size() - REPLAY_TOPIC_SUFFIX.size(), string::npos, REPLAY_TOPIC_SUFFIX) == 0))
+                    log_frames.push_back(i);
+            }
+            if (log_frames.empty()) {
+                log_reader.reset();
+                throw logic_error("Load Image found no '" + REPLAY_TOPIC_SUFFIX + "' frame in: " + log_path);
+            }
         } else {
-            initialized = false;
+            const bool recursive = false;
+            vector<cv::String> img_list;
+            // Load the list of jpg image contained in the config_folder/img_to_load/
+            cv::glob(config_folder + "/img_to_load/*.jpg", img_list, recursive);
+
+            if (img_list.size() == 0) {
+                throw logic_error("Load Image can not find any jpg image in: " +  config_folder + "/img_to_load/");
+            }
+            replayer.reset(new FrameReplay::FrameReplayer(vector<string>(img_list.begin(), img_list.end()),
+                                                          LOAD_IMAGE_HOLD, LOAD_IMAGE_END,
+                                                          LOAD_IMAGE_PREFETCH));
         }
     }
 
-    if (!initialized) {
-        throw logic_error("Load Image can not find any jpg image in: " +  config_folder + "/img_to_load/");
+    if (log_reader) {
+        img_out = log_reader->at(log_frames[log_idx]).image;
+        if (++log_calls >= LOAD_IMAGE_HOLD) {
+            log_calls = 0;
+            if (log_idx + 1 < log_frames.size())
+                ++log_idx;
+            else if (LOAD_IMAGE_END == FrameReplay::EndPolicy::loop)
+                log_idx = 0;
+        }
         return;
     }
 
-    img_out = current_img;
-    function_call_counter++;
-
-    // If the function is called more than N times load increment image idx
-    if (function_call_counter > freeze_img_n_step) {
-        function_call_counter = 0;
-        idx = (idx + 1)%img_list.size();
-        current_img = cv::imread(img_list[idx]);
-    }
+    replayer->next(img_out);    // at the end of the list with EndPolicy::stop the last image is kept
 }
 
-/** Saves an image when S key is pressed.
+/** Shows the camera frames and saves a snapshot when S key is pressed.
+ * The window is driven by a display thread (see Display::DisplayThread):
+ * this callback only posts the frame and collects the save requests of the
+ * key presses. Snapshots are saved as config_folder/<topic>_<n>.jpg, ready to
+ * be copied to img_to_load/ and replayed by loadImage.
+ * With FRAME_LOG_RECORDING snapshots (and every frame, with RECORD_SESSION)
+ * are also appended to the FRAME_LOG_FILE frame log by a writer thread, so
+ * the callback never blocks on encoding or on disk for them.
+ * With HEADLESS no HighGUI call is made at all.
  * @param img_in Input image.
  * @param topic Image topic name.
  * @param config_folder Configuration folder path.
@@ -202,27 +513,38 @@ void loadImage(cv::Mat& img_out, const string& config_folder) {
 void genericImageListener(const cv::Mat& img_in, string topic,
                           const string& config_folder) {
 
-        static int imageCounter= 0;
+    #ifdef FRAME_LOG_RECORDING
+        static unique_ptr<FrameLog::Recorder> recorder;
+        if (!recorder) {
+            const string log_path = config_folder + FRAME_LOG_FILE;
+            experimental::filesystem::create_directories(experimental::filesystem::path(log_path).parent_path());
+            recorder.reset(new FrameLog::Recorder(log_path, FRAME_LOG_ENCODING));
+        }
 
-        cv::imshow("current picture", img_in);
-        char c = cv::waitKey(30);
-        if (c == 's') {
-        /* Create folder for images*/
-        string foldername = config_folder;
-        foldername += "/image";      //This is the folder used in the topic string
-        string command = "mkdir -p " + foldername;  //-p creates only if non exists
-        int state = system(command.c_str());  //use bash command
-        if (state != 0)
-            throw std::logic_error("Python script returned bad value");
-        /* Save current image */
-        string filename = config_folder;
-        filename += topic;
-        filename += "_";
-        filename += to_string(imageCounter++);
-        filename += ".jpg";
-        cv::imwrite(filename, img_in);
-        printf("Saved is '%s'\n", filename.c_str());
-    }
+        if (RECORD_SESSION)
+            recorder->record(topic, img_in);
+    #endif
+
+    #ifndef HEADLESS
+        static int imageCounter= 0;
+        static unique_ptr<Display::DisplayThread> display;
+        if (!display)
+            display.reset(new Display::DisplayThread("current picture", 's', DISPLAY_KEY_POLL_MS));
+
+        display->show(topic, img_in);
+
+        Display::Frame snapshot;
+        while (display->takeSaveRequest(snapshot)) {
+            /* Save current image */
+            const string filename = config_folder + snapshot.topic + "_" + to_string(imageCounter++) + ".jpg";
+            experimental::filesystem::create_directories(experimental::filesystem::path(filename).parent_path());
+            cv::imwrite(filename, snapshot.image);
+            printf("Saved is '%s'\n", filename.c_str());
+            #ifdef FRAME_LOG_RECORDING
+                recorder->record(snapshot.topic + SNAPSHOT_TOPIC_SUFFIX, snapshot.image);
+            #endif
+        }
+    #endif
 }
 
 /** Loads color bounds configuration from file.
@@ -293,7 +615,8 @@ void tune_color_parameters(const cv::Mat &image, const string& config_folder) {
     string file_path = config_folder;
     file_path += "/";
     file_path += COLOR_CONFIG_FILE;
-    // Call routine in panel library
+    // Call routine in panel library (it opens its own windows)
+    Display::GuiLock gui;
     hsvpanel::show_panel(image,file_path);
     cout << "tuned" << endl;
 }
@@ -312,10 +635,49 @@ bool extrinsicCalib(const cv::Mat& img_in, vector<cv::Point3f> object_points,
                     cv::Mat& tvec, const string& config_folder) {
     vector<cv::Point2f> corners;
 
-    if (AUTO_CORNER_DETECTION)
-        corners = CornerDetection::autodetect(img_in);
-    else {
-        corners = CornerDetection::manualSelect(img_in,config_folder);
+    #ifdef FUSED_RECTIFICATION
+        rectification.fill(img_in);     // undistortion deferred by imageUndistort
+    #endif
+
+    #ifdef CALIBRATION_CACHE
+        // Reuse the last calibration if the camera did not move
+        const uint64_t frame_hash = ImageHash::dHash(img_in);
+        CalibrationCache::Entry cached;
+        // the hash misses small camera bumps: the corners must also be found
+        // again where they were on the calibration frame
+        bool reuse = CalibrationCache::load(config_folder + CALIBRATION_CACHE_FILE, cached) &&
+                     cached.matches(frame_hash, img_in.size(), camera_matrix, CALIBRATION_CACHE_MAX_DISTANCE);
+        if (reuse) {
+            vector<cv::Point2f> checked = cached.corners;
+            reuse = CornerDetection::refineCorners(img_in, cached.cornerThreshold, CALIBRATION_CACHE_CHECK_RADIUS, checked) &&
+                    cached.cornersMatch(checked, CALIBRATION_CACHE_MAX_CORNER_SHIFT);
+            #ifdef DEBUG_EXTRINSIC_CALIB
+                if (!reuse)
+                    cout << "Extrinsic calibration cache rejected: the arena corners moved" << endl;
+            #endif
+        }
+        if (reuse) {
+            #ifdef DEBUG_EXTRINSIC_CALIB
+                cout << "Extrinsic calibration loaded from " << config_folder + CALIBRATION_CACHE_FILE << endl;
+            #endif
+            calibration = cached;
+            calibrationFromCache = true;
+            rvec = cached.rvec.clone();
+            tvec = cached.tvec.clone();
+
+            if(COLOR_TUNING_WIZARD)
+                tune_color_parameters(img_in, config_folder);
+            return true;
+        }
+    #endif
+
+    {
+        Display::GuiLock gui;   // manual selection and debug views open their own windows
+        if (AUTO_CORNER_DETECTION)
+            corners = CornerDetection::autodetect(img_in, DETECTION_PYRAMID_LEVELS);
+        else {
+            corners = CornerDetection::manualSelect(img_in,config_folder);
+        }
     }
 
     #ifdef DEBUG_EXTRINSIC_CALIB
@@ -336,13 +698,33 @@ bool extrinsicCalib(const cv::Mat& img_in, vector<cv::Point3f> object_points,
         cv::putText(calibDebugImg, "3", corners[3], cv::FONT_HERSHEY_DUPLEX, 1.0, cv::Scalar(0,0,255), 2);
 
         // display
-        cv::imshow("Selected border points", calibDebugImg);
-        cv::waitKey(0);
+        showDebugImage("Selected border points", calibDebugImg);
     #endif
 
     cv::Mat nullmat;
     cv::solvePnP(object_points,corners, camera_matrix, nullmat, rvec, tvec);
 
+    #ifdef CALIBRATION_CACHE
+        calibration = CalibrationCache::Entry();
+        calibration.hash = frame_hash;
+        calibration.size = img_in.size();
+        calibration.cameraMatrix = camera_matrix.clone();
+        calibration.corners = corners;
+        calibration.rvec = rvec.clone();
+        calibration.tvec = tvec.clone();
+        {
+            cv::Mat gray, mask;
+            cv::cvtColor(img_in, gray, cv::COLOR_BGR2GRAY);
+            calibration.cornerThreshold = cv::threshold(gray, mask, 0, 255, cv::THRESH_BINARY_INV | cv::THRESH_OTSU);
+        }
+        calibration.checkCorners = corners;
+        if (!CornerDetection::refineCorners(img_in, calibration.cornerThreshold, CALIBRATION_CACHE_CHECK_RADIUS,
+                                            calibration.checkCorners))
+            calibration.checkCorners.clear();   // corners not found again: never reused
+        calibrationFromCache = false;
+        CalibrationCache::save(config_folder + CALIBRATION_CACHE_FILE, calibration);
+    #endif
+
     // Call the routine with gui to tune the color values
     if(COLOR_TUNING_WIZARD)
         tune_color_parameters(img_in, config_folder);
@@ -350,6 +732,13 @@ bool extrinsicCalib(const cv::Mat& img_in, vector<cv::Point3f> object_points,
 }
 
 /** Undistorts the input image.
+ * The undistortion maps are computed once and cached.
+ * With FUSED_RECTIFICATION the raw frame is remembered with its undistorted
+ * image: unwarp then undistorts and unwarps the raw frame with a single remap
+ * pass instead of resampling the undistorted image again. Once the plane
+ * transform is known, the undistortion itself is deferred until the
+ * undistorted image is read (see RemapCache::fill), so each frame is
+ * resampled only once.
  * @param img_in Input distorted image.
  * @param img_out Output corrected image.
  * @param cam_matrix Input camera matrix.
@@ -359,7 +748,34 @@ void imageUndistort(const cv::Mat& img_in, cv::Mat& img_out,
                     const cv::Mat& cam_matrix, const cv::Mat& dist_coeffs,
                     const string& config_folder) {
 
-    cv::undistort(img_in,img_out,cam_matrix,dist_coeffs);
+    #ifdef FUSED_RECTIFICATION
+        rectification.setIntrinsics(cam_matrix, dist_coeffs);
+        const bool deferred = rectification.canFuse();
+        // the caller may reuse the input buffer for the output
+        const cv::Mat raw = (!deferred && (img_in.data == img_out.data)) ? img_in.clone() : img_in;
+    #else
+        const cv::Mat& raw = img_in;
+    #endif
+    #ifdef PIPELINED_LOCALIZATION
+        if (localizationPipeline) {
+            // the frame is rectified and analyzed by the pipeline threads,
+            // the buffer may be reused by the caller so it is copied
+            LocalizationFrame frame;
+            frame.image = raw.clone();
+            localizationPipeline->push(frame);
+        }
+    #endif
+    #ifdef FUSED_RECTIFICATION
+        if (deferred) {
+            // unwarp and findRobot only read the raw frame
+            rectification.deferUndistort(raw, img_out);
+            return;
+        }
+    #endif
+    rectification.undistort(raw, img_out, cam_matrix, dist_coeffs);
+    #ifdef FUSED_RECTIFICATION
+        rectification.setSource(raw, img_out);
+    #endif
 }
 
 /** Calculates a perspetive transform.
@@ -379,15 +795,53 @@ void findPlaneTransform(const cv::Mat& cam_matrix, const cv::Mat& rvec,
     #ifdef DEBUG_FINDPLANETRANSFORM
         cout << "findPlaneTransform called" << endl;
     #endif
+    #ifdef CALIBRATION_CACHE
+        if (calibrationFromCache && !calibration.planeTransf.empty() &&
+            Rectification::sameMatrix(rvec, calibration.rvec) &&
+            Rectification::sameMatrix(tvec, calibration.tvec)) {
+            plane_transf = calibration.planeTransf.clone();
+            #ifdef FUSED_RECTIFICATION
+                rectification.setPlaneTransform(plane_transf);
+                Rectification::RemapTable table;
+                if (Rectification::sameMatrix(rectification.distCoeffs(), calibration.distCoeffs) &&
+                    CalibrationCache::loadTable(config_folder + CALIBRATION_REMAP_FILE, calibration.size, table))
+                    rectification.setFused(table, calibration.size);
+            #endif
+            return;
+        }
+    #endif
+
     cv::Mat image_points;
 
     // project points
     cv::projectPoints(object_points_plane, rvec, tvec, cam_matrix, cv::Mat(), image_points);
 
     plane_transf = cv::getPerspectiveTransform(image_points, dest_image_points_plane);
+
+    #ifdef FUSED_RECTIFICATION
+        rectification.setPlaneTransform(plane_transf);
+    #endif
+
+    #ifdef CALIBRATION_CACHE
+        if (Rectification::sameMatrix(rvec, calibration.rvec)) {
+            calibration.planeTransf = plane_transf.clone();
+            #ifdef FUSED_RECTIFICATION
+                if (rectification.canFuse()) {
+                    calibration.distCoeffs = rectification.distCoeffs().clone();
+                    CalibrationCache::saveTable(config_folder + CALIBRATION_REMAP_FILE,
+                                                rectification.fused(calibration.size));
+                }
+            #endif
+            CalibrationCache::save(config_folder + CALIBRATION_CACHE_FILE, calibration);
+        }
+    #endif
 }
 
 /** Applies a perspective transform to an image.
+ * Images undistorted by imageUndistort (FUSED_RECTIFICATION) are unwarped
+ * from their raw frame with the precomputed fused remap table.
+ * With ROBOT_POINT_LOCALIZATION, after the map is processed these images are
+ * forwarded as they are: findRobot localizes the robot on their raw frame.
  * @param img_in Input image.
  * @param img_out Output unwarped image.
  * @param transf Transformation matrix.
@@ -396,9 +850,41 @@ void findPlaneTransform(const cv::Mat& cam_matrix, const cv::Mat& rvec,
 void unwarp(const cv::Mat& img_in, cv::Mat& img_out, const cv::Mat& transf,
             const string& config_folder) {
 
+    #ifdef FUSED_RECTIFICATION
+        const cv::Mat raw = rectification.sourceOf(img_in);
+        if (!raw.empty()) {
+            #ifdef PIPELINED_LOCALIZATION
+                if (localizationPipeline) {
+                    // rectified by the pipeline (see imageUndistort)
+                    img_out = img_in;
+                    return;
+                }
+            #endif
+            #ifdef ROBOT_POINT_LOCALIZATION
+                if (mapProcessed) {
+                    // Localization only needs the raw frame (see findRobotRaw)
+                    img_out = img_in;
+                    return;
+                }
+            #endif
+            rectification.rectify(raw, img_out, transf);
+            return;
+        }
+    #endif
     cv::warpPerspective(img_in, img_out, transf, img_in.size());
 }
 
+/** Obstacle dilation accounting for the robot dimensions.
+ * @param scale Scaling factor.
+ * @return Dilation size (pixels).
+*/
+int obstacleDilation(const double scale) {
+    // compute robot dimension from barycenter for obstacle dilation
+    // distance between robot triangle front vertex and barycenter is triangle height/3*2
+    // from documentation, triangle height is 16 cm
+    return ceil(1.2 * ROBOT_RADIUS * scale);
+}
+
 /** Find arena obstacles.
  * Finds the obstacles in the arena given the arena image and dilate to account
  * for robot dimensions.
@@ -407,10 +893,12 @@ void unwarp(const cv::Mat& img_in, cv::Mat& img_out, const cv::Mat& transf,
  * @param scale Scaling factor.
  * @param obstacle_list List of output obstacle polygons.
  * @param color_config Color bounds configuration.
+ * @param areas Non overlapping image areas to search.
 */
 void findObstacles(const cv::Mat& hsv_img, const double scale,
                    vector<Polygon>& obstacle_list,
-                   const Color_config& color_config) {
+                   const Color_config& color_config,
+                   const vector<cv::Rect>& areas) {
 
     /* Red color requires 2 ranges*/
     cv::Mat lower_red_hue_range; // the lower range for red hue
@@ -439,55 +927,123 @@ void findObstacles(const cv::Mat& hsv_img, const double scale,
     #ifdef DEBUG_COLOR_RANGE
         printf("Using RED bound 2 (%d,%d,%d)-(%d,%d,%d)\n", lowH2, lowS2,  lowV2, highH2, highS2, highV2);
     #endif
-    cv::inRange(hsv_img, cv::Scalar(lowH1, lowS1, lowV1), cv::Scalar(highH1, highS1, highV1), lower_red_hue_range);
-    cv::inRange(hsv_img, cv::Scalar(lowH2, lowS2, lowV2), cv::Scalar(highH2, highS2, highV2), upper_red_hue_range);
-
-    // Now we can combine the 2 masks
-    cv::Mat red_hue_image;
-    cv::addWeighted(lower_red_hue_range, 1.0, upper_red_hue_range, 1.0, 0.0, red_hue_image);
-    //This can reduce false positives
+    const vector<CoarseDetection::ColorRange> red_ranges = {
+        make_pair(cv::Scalar(lowH1, lowS1, lowV1), cv::Scalar(highH1, highS1, highV1)),
+        make_pair(cv::Scalar(lowH2, lowS2, lowV2), cv::Scalar(highH2, highS2, highV2))
+    };
 
-    // compute robot dimension from barycenter for obstacle dilation
-    // distance between robot triangle front vertex and barycenter is triangle height/3*2
-    // from documentation, triangle height is 16 cm
-    float robot_dim = ceil(1.2 * ROBOT_RADIUS * scale);
+    float robot_dim = obstacleDilation(scale);
 
     #ifdef DEBUG_FINDOBSTACLES
         cout << "robot dim: " << robot_dim << endl;
     #endif
 
-    // dilate obstacles
-    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(robot_dim, robot_dim));
-    cv::dilate(red_hue_image, red_hue_image, kernel);
-
-    /*
-    * Now the mask has to undergo contour detection
-    */
+    #ifdef DEBUG_BENCH_DILATION
+        cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(robot_dim, robot_dim));
+    #endif
 
     vector<vector<cv::Point>> contours, contours_approx;
     vector<cv::Point> approx_curve;
-    cv::Mat contours_img;
-    contours_img = hsv_img.clone();
+    #ifdef DEBUG_FINDOBSTACLES
+        cv::Mat contours_img;
+        contours_img = hsv_img.clone();
+    #endif
 
-    cv::findContours(red_hue_image, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    // Regions containing obstacles, padded to contain the dilated obstacles
+    // (the whole areas if DETECTION_PYRAMID_LEVELS is 0)
+    vector<cv::Rect> rois = CoarseDetection::blobROIs(hsv_img, red_ranges,
+                                                      DETECTION_PYRAMID_LEVELS,
+                                                      robot_dim + 1, areas);
+
+    for (const cv::Rect& roi : rois) {
+        cv::Mat roi_hsv = hsv_img(roi);
+    #ifdef RLE_MASKS
+        // threshold, union and dilation work on runs, contours are traced on
+        // the bounding box of each blob only
+        RLE::Mask red_mask = RLE::unite(RLE::threshold(roi_hsv, red_ranges[0].first, red_ranges[0].second),
+                                        RLE::threshold(roi_hsv, red_ranges[1].first, red_ranges[1].second));
+
+        // dilate obstacles on the bounding box of each blob, with the
+        // dilation of the dense masks (constant cost per pixel, whatever robot_dim)
+        #ifdef DEBUG_BENCH_DILATION
+            const cv::Rect roi_frame(cv::Point(0, 0), roi.size());
+            cv::Mat input, reference;
+            red_mask.rasterize(roi_frame, input);
+            auto bench_start = chrono::steady_clock::now();
+            cv::dilate(input, reference, kernel);
+            auto bench_mid = chrono::steady_clock::now();
+        #endif
+        red_mask = RLE::dilate(red_mask, OBSTACLE_DILATION_SHAPE, robot_dim);
+        #ifdef DEBUG_BENCH_DILATION
+            auto bench_end = chrono::steady_clock::now();
+            cv::Mat rect_result, diff;
+            RLE::dilateRect(RLE::encode(input), cv::Size(robot_dim, robot_dim)).rasterize(roi_frame, rect_result);
+            cv::compare(rect_result, reference, diff, cv::CMP_NE);
+            cout << "Dilation " << roi.size() << " kernel " << robot_dim
+                 << ": cv::dilate " << chrono::duration<double, milli>(bench_mid - bench_start).count()
+                 << " ms, RLE::dilate " << chrono::duration<double, milli>(bench_end - bench_mid).count()
+                 << " ms, rect mismatches " << cv::countNonZero(diff) << endl;
+        #endif
 
-    drawContours(contours_img, contours, -1, cv::Scalar(40,190,40), 3, cv::LINE_AA); //REMOVE
-    for (size_t i=0; i<contours.size(); ++i) {
-        approxPolyDP(contours[i], approx_curve, 3, true);
+        contours.clear();
+        for (const RLE::Component& blob : RLE::components(red_mask, roi.tl()))
+            contours.push_back(blob.contour);
+    #else
+        cv::inRange(roi_hsv, red_ranges[0].first, red_ranges[0].second, lower_red_hue_range);
+        cv::inRange(roi_hsv, red_ranges[1].first, red_ranges[1].second, upper_red_hue_range);
+
+        // Now we can combine the 2 masks
+        cv::Mat red_hue_image;
+        cv::addWeighted(lower_red_hue_range, 1.0, upper_red_hue_range, 1.0, 0.0, red_hue_image);
+        //This can reduce false positives
+
+        // dilate obstacles (constant cost per pixel, whatever robot_dim)
+        #ifdef DEBUG_BENCH_DILATION
+            cv::Mat input = red_hue_image.clone(), reference;
+            auto bench_start = chrono::steady_clock::now();
+            cv::dilate(red_hue_image, reference, kernel);
+            auto bench_mid = chrono::steady_clock::now();
+        #endif
+        Morphology::dilate(red_hue_image, red_hue_image, OBSTACLE_DILATION_SHAPE, robot_dim);
+        #ifdef DEBUG_BENCH_DILATION
+            auto bench_end = chrono::steady_clock::now();
+            cv::Mat rect_result, diff;
+            Morphology::dilateRect(input, rect_result, cv::Size(robot_dim, robot_dim));
+            cv::compare(rect_result, reference, diff, cv::CMP_NE);
+            cout << "Dilation " << roi.size() << " kernel " << robot_dim
+                 << ": cv::dilate " << chrono::duration<double, milli>(bench_mid - bench_start).count()
+                 << " ms, Morphology::dilate " << chrono::duration<double, milli>(bench_end - bench_mid).count()
+                 << " ms, rect mismatches " << cv::countNonZero(diff) << endl;
+        #endif
 
-        Polygon scaled_contour;
-        for (const auto& pt: approx_curve) {
-            scaled_contour.emplace_back(pt.x/scale, pt.y/scale);
-        }
-        obstacle_list.push_back(scaled_contour);
+        /*
+        * Now the mask has to undergo contour detection
+        */
+
+        cv::findContours(red_hue_image, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE, roi.tl());
+    #endif
+
+        #ifdef DEBUG_FINDOBSTACLES
+            drawContours(contours_img, contours, -1, cv::Scalar(40,190,40), 3, cv::LINE_AA);
+        #endif
+        for (size_t i=0; i<contours.size(); ++i) {
+            approxPolyDP(contours[i], approx_curve, 3, true);
+
+            Polygon scaled_contour;
+            for (const auto& pt: approx_curve) {
+                scaled_contour.emplace_back(pt.x/scale, pt.y/scale);
+            }
+            obstacle_list.push_back(scaled_contour);
 
-        contours_approx = {approx_curve};
-        cv::drawContours(contours_img, contours_approx, -1, cv::Scalar(0,0,255), 1, cv::LINE_AA);
+            #ifdef DEBUG_FINDOBSTACLES
+                contours_approx = {approx_curve};
+                cv::drawContours(contours_img, contours_approx, -1, cv::Scalar(0,0,255), 1, cv::LINE_AA);
+            #endif
+        }
     }
 
     #ifdef DEBUG_FINDOBSTACLES
-        imshow("obstacles", contours_img);
-        cv::waitKey(0);
+        showDebugImage("obstacles", contours_img);
     #endif
 }
 
@@ -497,10 +1053,11 @@ void findObstacles(const cv::Mat& hsv_img, const double scale,
  * @param scale Scaling factor.
  * @param gate Polygon that represents the gate.
  * @param color_config Color bounds configuration.
+ * @param areas Non overlapping image areas to search.
  * @return True if gate was found.
 */
 bool findGate(const cv::Mat& hsv_img, const double scale, Polygon& gate,
-             const Color_config& color_config) {
+             const Color_config& color_config, const vector<cv::Rect>& areas) {
 
     // Find green regions
     auto t = color_config.victims_lowbound;
@@ -516,60 +1073,170 @@ bool findGate(const cv::Mat& hsv_img, const double scale, Polygon& gate,
         printf("Using GREEN bound  (%d,%d,%d)-(%d,%d,%d)\n", lowH, lowS, lowV, highH, highS, highV);
     #endif
 
-    cv::Mat green_mask;
-    cv::inRange(hsv_img, cv::Scalar(lowH, lowS, lowV), cv::Scalar(highH, highS, highV), green_mask);
+    const vector<CoarseDetection::ColorRange> green_ranges = {
+        make_pair(cv::Scalar(lowH, lowS, lowV), cv::Scalar(highH, highS, highV))
+    };
 
     vector<vector<cv::Point>> contours, contours_approx;
     vector<cv::Point> approx_curve;
-    cv::Mat contours_img;
-    contours_img = hsv_img.clone();
-
-    cv::findContours(green_mask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    #ifdef DEBUG_FINDGATE
+        cv::Mat contours_img;
+        contours_img = hsv_img.clone();
+    #endif
 
     bool res = false;
 
-    for (auto& contour : contours) {
-        //const double area = cv::contourArea(contour);
-        //cout << "AREA " << area << endl;
-        //cout << "SIZE: " << contours.size() << endl;
+    // Regions containing green blobs (the whole areas if DETECTION_PYRAMID_LEVELS is 0)
+    vector<cv::Rect> rois = CoarseDetection::blobROIs(hsv_img, green_ranges,
+                                                      DETECTION_PYRAMID_LEVELS, 2, areas);
+
+    for (const cv::Rect& roi : rois) {
+    #ifdef RLE_MASKS
+        contours.clear();
+        RLE::Mask green_mask = RLE::threshold(hsv_img(roi), green_ranges[0].first, green_ranges[0].second);
+        for (const RLE::Component& blob : RLE::components(green_mask, roi.tl()))
+            contours.push_back(blob.contour);
+    #else
+        cv::Mat green_mask;
+        cv::inRange(hsv_img(roi), green_ranges[0].first, green_ranges[0].second, green_mask);
+
+        cv::findContours(green_mask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE, roi.tl());
+    #endif
 
-        approxPolyDP(contour, approx_curve, 10, true);
+        for (auto& contour : contours) {
+            //const double area = cv::contourArea(contour);
+            //cout << "AREA " << area << endl;
+            //cout << "SIZE: " << contours.size() << endl;
 
-        if (approx_curve.size() != 4) continue;
+            approxPolyDP(contour, approx_curve, 10, true);
 
-        contours_approx = {approx_curve};
-        drawContours(contours_img, contours_approx, -1, cv::Scalar(0,170,220), 3, cv::LINE_AA);
+            if (approx_curve.size() != 4) continue;
 
-        for (const auto& pt: approx_curve) {
-          gate.emplace_back(pt.x/scale, pt.y/scale);
-        }
+            #ifdef DEBUG_FINDGATE
+                contours_approx = {approx_curve};
+                drawContours(contours_img, contours_approx, -1, cv::Scalar(0,170,220), 3, cv::LINE_AA);
+            #endif
+
+            for (const auto& pt: approx_curve) {
+              gate.emplace_back(pt.x/scale, pt.y/scale);
+            }
 
-        res = true;
+            res = true;
+        }
     }
 
     #ifdef DEBUG_FINDGATE
-        cv::imshow("findGate", contours_img);
-        cv::waitKey(0);
+        showDebugImage("findGate", contours_img);
     #endif
 
     return res;
 }
 
+/** Scratch buffers of a digit recognition worker.
+ * Every worker owns one instance, so buffers are reused from one victim to
+ * the next and never shared between threads.
+*/
+struct DigitScratch {
+    cv::Mat bgr;        ///< BGR copy of the blob bounding box.
+    cv::Mat maskInv;    ///< Inverted green mask of the blob bounding box.
+    cv::Mat filtered;   ///< Blob without green pixels (digit only).
+    cv::Mat digit;      ///< Resized and filtered digit.
+    cv::Mat gray;       ///< Grayscale digit.
+    cv::Mat aligned;    ///< Digit aligned with the axes, used for matching.
+    cv::Mat result;     ///< Template matching result.
+    vector<vector<cv::Point>> contours; ///< Contours of the digit.
+};
+
+/** Recognizes the digit of a single victim.
+ * Runs the whole recognition chain on the bounding box of one green blob:
+ * ROI extraction, flip, resize, threshold, morphology, rotation alignment and
+ * template matching. Only the bounding box is read from the input images.
+ * @param hsv_img HSV input image.
+ * @param box_mask Mask of the green regions inside the bounding box.
+ * @param box Bounding box of the victim blob.
+ * @param templROIs Digit templates, four 90 degree orientations per digit.
+ * @param kernel Erosion kernel.
+ * @param s Worker scratch buffers.
+ * @return The best matching digit, -1 if the blob is rejected.
+*/
+int recognizeVictimDigit(const cv::Mat& hsv_img, const cv::Mat& box_mask,
+                         const cv::Rect& box, const vector<cv::Mat>& templROIs,
+                         const cv::Mat& kernel, DigitScratch& s) {
+    if (box.area() == 0) return -1;
+
+    // create copy of the ROI without green shapes -> black numbers on white
+    cv::cvtColor(hsv_img(box), s.bgr, cv::COLOR_HSV2BGR);
+    cv::bitwise_not(box_mask, s.maskInv);
+    s.filtered.create(box.size(), CV_8UC3);
+    s.filtered.setTo(cv::Scalar(255,255,255));
+    s.bgr.copyTo(s.filtered, s.maskInv);
+
+    // FLIP HERE
+    cv::flip(s.filtered, s.filtered, 0);
+
+    cv::resize(s.filtered, s.digit, cv::Size(200, 200)); // resize the ROI
+    cv::threshold(s.digit, s.digit, 100, 255, 0); // threshold and binarize the image, to suppress some noise
+
+    // Apply some additional smoothing and filtering
+    cv::erode(s.digit, s.digit, kernel);
+    cv::GaussianBlur(s.digit, s.digit, cv::Size(5, 5), 2, 2);
+    cv::erode(s.digit, s.digit, kernel);
+
+    // advanced ROI with rotation
+    cv::cvtColor(s.digit, s.gray, cv::COLOR_BGR2GRAY);
+    cv::bitwise_not(s.gray, s.gray);
+
+    // extract minimum rectangle enclosing the number
+    cv::findContours(s.gray, s.contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    if (s.contours.empty()) return -1;
+    cv::RotatedRect minRect = minAreaRect(cv::Mat(s.contours[0]));
+
+    // rotate min rectangle to align with axes
+    cv::Mat rotM = cv::getRotationMatrix2D(minRect.center, minRect.angle, 1.0);
+    cv::warpAffine(s.gray, s.gray, rotM, s.gray.size(), cv::INTER_CUBIC);
+    cv::bitwise_not(s.gray, s.gray);
+    cv::cvtColor(s.gray, s.aligned, cv::COLOR_GRAY2BGR);
+
+    // Find the template digit with the best matching
+    double maxScore = 0;
+    int maxIdx = -1;
+    for (size_t j = 0; j < templROIs.size(); ++j) {
+        cv::matchTemplate(s.aligned, templROIs[j], s.result, cv::TM_CCOEFF);
+        double score;
+        cv::minMaxLoc(s.result, nullptr, &score);
+        if (score > maxScore) {
+            maxScore = score;
+            maxIdx = floor(j/4);
+        }
+    }
+
+    // Show the actual image used for the template matching
+    #ifdef DEBUG_FINDVICTIMS
+        showDebugImage("ROI", s.aligned);
+    #endif
+
+    return maxIdx;
+}
+
 /** Finds the victims in the arena given the arena image and detects victim number.
  * Victim color is green. Number is detected by template matching. Template matching is performed
  * by extracting the axes-aligned minimal bounding rectangle for each region of interest and comparing it
  * with the templates in four 90 degree orientations to maximize the matching score.
+ * Blobs are recognized concurrently (see VICTIM_RECOGNITION_THREADS); the
+ * output keeps the order in which blobs are found.
  * @param hsv_img HSV input image.
  * @param scale Scaling factor.
  * @param victim_list List of output victim polygons.
  * @param color_config Color bounds configuration.
  * @param config_folder Configuration folder path.
+ * @param areas Non overlapping image areas to search.
  * @return True if victims were found.
 */
 bool findVictims(const cv::Mat& hsv_img, const double scale,
                  vector<pair<int,Polygon>>& victim_list,
                  const Color_config& color_config,
-                 const string& config_folder) {
+                 const string& config_folder,
+                 const vector<cv::Rect>& areas) {
 
     // Find green regions
     auto t = color_config.victims_lowbound;
@@ -585,61 +1252,89 @@ bool findVictims(const cv::Mat& hsv_img, const double scale,
         printf("Using GREEN bound  (%d,%d,%d)-(%d,%d,%d)\n", lowH, lowS, lowV, highH, highS, highV);
     #endif
 
-    cv::Mat green_mask;
-    cv::inRange(hsv_img, cv::Scalar(lowH, lowS, lowV), cv::Scalar(highH, highS, highV), green_mask);
+    const vector<CoarseDetection::ColorRange> green_ranges = {
+        make_pair(cv::Scalar(lowH, lowS, lowV), cv::Scalar(highH, highS, highV))
+    };
 
     vector<vector<cv::Point>> contours, contours_approx;
     vector<cv::Point> approx_curve;
-    cv::Mat contours_img;
-    contours_img = hsv_img.clone();
+    #ifdef DEBUG_FINDVICTIMS
+        cv::Mat contours_img;
+        contours_img = hsv_img.clone();
+    #endif
 
-    cv::findContours(green_mask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    vector<cv::Rect> boundRect;       // bounding box of each victim blob
+    vector<cv::Mat> blobMask;         // green mask of each bounding box
+    vector<Polygon> polygonsFound;    // scaled polygon of each victim blob
+
+    // Regions containing green blobs (the whole areas if DETECTION_PYRAMID_LEVELS is 0)
+    vector<cv::Rect> rois = CoarseDetection::blobROIs(hsv_img, green_ranges,
+                                                      DETECTION_PYRAMID_LEVELS, 2, areas);
+
+    for (const cv::Rect& roi : rois) {
+    #ifdef RLE_MASKS
+        RLE::Mask green_runs = RLE::threshold(hsv_img(roi), green_ranges[0].first, green_ranges[0].second);
+        contours.clear();
+        for (const RLE::Component& blob : RLE::components(green_runs, roi.tl()))
+            contours.push_back(blob.contour);
+    #else
+        cv::Mat green_mask;     // new buffer per ROI, the blob masks are views on it
+        cv::inRange(hsv_img(roi), green_ranges[0].first, green_ranges[0].second, green_mask);
+    #endif
 
-    vector<cv::Rect> boundRect(contours.size());
-    vector<cv::RotatedRect> minRect(contours.size());
-    vector<Polygon> polygonsFound(contours.size());
+        #ifdef DEBUG_FINDVICTIMS
+            // generate binary mask with inverted pixels w.r.t. green mask -> black numbers are part of this mask
+            cv::Mat green_mask_inv;
+            #ifdef RLE_MASKS
+                green_runs.rasterize(cv::Rect(cv::Point(), roi.size()), green_mask_inv);
+                cv::bitwise_not(green_mask_inv, green_mask_inv);
+            #else
+                cv::bitwise_not(green_mask, green_mask_inv);
+            #endif
+            showDebugImage("Numbers", green_mask_inv);
+        #endif
 
-    for (size_t i=0; i<contours.size(); ++i) {
-        approxPolyDP(contours[i], approx_curve, 10, true);
+    #ifndef RLE_MASKS
+        cv::findContours(green_mask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE, roi.tl());
+    #endif
 
-        if (approx_curve.size() != 4) {  // ignore gate
+        for (size_t i=0; i<contours.size(); ++i) {
+            approxPolyDP(contours[i], approx_curve, 10, true);
 
-            Polygon scaled_contour;
-            for (const auto& pt: approx_curve) {
-                scaled_contour.emplace_back(pt.x/scale, pt.y/scale);
-            }
-            polygonsFound[i] = scaled_contour;
+            if (approx_curve.size() != 4) {  // ignore gate
 
-            contours_approx = {approx_curve};
-            drawContours(contours_img, contours_approx, -1, cv::Scalar(0,170,220), 3, cv::LINE_AA);
-            boundRect[i] = boundingRect(cv::Mat(approx_curve)); // find bounding box for each green blob
-            minRect[i] = minAreaRect(cv::Mat(contours[i]));
+                Polygon scaled_contour;
+                for (const auto& pt: approx_curve) {
+                    scaled_contour.emplace_back(pt.x/scale, pt.y/scale);
+                }
+                polygonsFound.push_back(scaled_contour);
+
+                #ifdef DEBUG_FINDVICTIMS
+                    contours_approx = {approx_curve};
+                    drawContours(contours_img, contours_approx, -1, cv::Scalar(0,170,220), 3, cv::LINE_AA);
+                #endif
+                // find bounding box for each green blob
+                cv::Rect box = boundingRect(cv::Mat(approx_curve)) & roi;
+                boundRect.push_back(box);
+            #ifdef RLE_MASKS
+                blobMask.emplace_back();
+                green_runs.rasterize(box - roi.tl(), blobMask.back());
+            #else
+                blobMask.push_back(green_mask(box - roi.tl()));
+            #endif
+            }
         }
     }
 
     #ifdef DEBUG_FINDVICTIMS
-        cv::imshow("findVictims", contours_img);
-        cv::waitKey(0);
+        showDebugImage("findVictims", contours_img);
     #endif
     // TEMPLATE MATCHING
 
-    cv::Mat img;
-    cv::cvtColor(hsv_img, img, cv::COLOR_HSV2BGR);
-
-    // generate binary mask with inverted pixels w.r.t. green mask -> black numbers are part of this mask
-    cv::Mat green_mask_inv, filtered(img.rows, img.cols, CV_8UC3, cv::Scalar(255,255,255));
-    cv::bitwise_not(green_mask, green_mask_inv);
-
-    #ifdef DEBUG_FINDVICTIMS
-        cv::imshow("Numbers", green_mask_inv);
-        cv::waitKey(0);
-    #endif
-    cv::Mat curr_num;
-
     // Load digits template images
     vector<cv::Mat> templROIs;
     for (int i = 0; i <= 5; ++i) {
-        curr_num = cv::imread(config_folder + "/../imgs/template/" + to_string(i) + ".png");
+        cv::Mat curr_num = cv::imread(config_folder + "/../imgs/template/" + to_string(i) + ".png");
         templROIs.emplace_back(curr_num);
 
         for (int j = 0; j < 3; ++j) {
@@ -648,79 +1343,212 @@ bool findVictims(const cv::Mat& hsv_img, const double scale,
         }
     }
 
-    img.copyTo(filtered, green_mask_inv);   // create copy of image without green shapes
-
     cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size((2*2) + 1, (2*2)+1));
 
-    contours.clear();
+    // Each green blob is recognized independently: spread them over the
+    // available cores, every worker with its own scratch buffers.
+    // Debug windows need the main thread and a deterministic order, so the
+    // recognition is serial when debugging.
+    #ifdef DEBUG_FINDVICTIMS
+        const unsigned int recognitionThreads = 1;
+    #else
+        const unsigned int recognitionThreads = VICTIM_RECOGNITION_THREADS;
+    #endif
+    const unsigned int workers = ParallelUtils::workerCount(boundRect.size(), recognitionThreads);
+    vector<DigitScratch> scratch(workers);
+    vector<int> digits(boundRect.size(), -1);  // indexed by blob, keeps the output order deterministic
+
+    ParallelUtils::parallelFor(boundRect.size(), [&](size_t i, unsigned int w) {
+        digits[i] = recognizeVictimDigit(hsv_img, blobMask[i], boundRect[i],
+                                         templROIs, kernel, scratch[w]);
+    }, workers);
 
-    // For each green blob in the original image containing a digit
     for (size_t i=0; i < boundRect.size(); ++i) {
-        cv::Mat processROI(filtered, boundRect[i]); // extract the ROI containing the digit
-
-        // FLIP HERE
-        cv::flip(processROI, processROI, 0);
+        if (digits[i] != -1) {
+            victim_list.push_back({digits[i], polygonsFound[i]});
+        }
 
-        if (processROI.empty()) continue;
+        cout << "Best fitting template: " << ((digits[i]==-1) ? "None (rejected)" : to_string(digits[i])) << " coordinates: (" << PUtils::baricenter(polygonsFound[i]).x << "," << PUtils::baricenter(polygonsFound[i]).y << ")" << endl;
+    }
 
-        cv::resize(processROI, processROI, cv::Size(200, 200)); // resize the ROI
-        cv::threshold(processROI, processROI, 100, 255, 0); // threshold and binarize the image, to suppress some noise
+    return true;
+}
 
-        // Apply some additional smoothing and filtering
-        cv::erode(processROI, processROI, kernel);
-        cv::GaussianBlur(processROI, processROI, cv::Size(5, 5), 2, 2);
-        cv::erode(processROI, processROI, kernel);
+/** Computes the visibility among the visibility graph vertices around the obstacles.
+ * Vertices lie VISIBILITY_VERTEX_MARGIN off the obstacles.
+ * @param inflated_obstacle_list List of inflated obstacle polygons.
+ * @return The obstacle visibility.
+*/
+shared_ptr<const Planning::ObstacleVisibility> obstacleVisibility(const vector<Polygon>& inflated_obstacle_list) {
+    vector<Point> vertices;
+    for (const Polygon& p : ClipperHelper::inflatePolygons(inflated_obstacle_list, VISIBILITY_VERTEX_MARGIN))
+        vertices.insert(vertices.end(), p.begin(), p.end());
+    return make_shared<const Planning::ObstacleVisibility>(inflated_obstacle_list, vertices);
+}
 
-        // advanced ROI with rotation
-        cv::cvtColor(processROI, processROI, cv::COLOR_BGR2GRAY);
-        cv::bitwise_not(processROI, processROI);
+/** Computes the planning geometry of a set of obstacles.
+ * @param obstacle_list List of obstacle polygons.
+ * @return The obstacle geometry.
+*/
+ObstacleGeometry computeObstacleGeometry(const vector<Polygon>& obstacle_list) {
+    ObstacleGeometry geometry;
+    geometry.obstacles = obstacle_list;
+    geometry.inflated = ClipperHelper::inflatePolygons(obstacle_list, SAFETY_INFLATE_AMOUNT);
+    if (POINT_PLANNER == PlannerBackend::visibilityGraph)
+        geometry.visibility = obstacleVisibility(geometry.inflated);
+    #ifdef DISTANCE_FIELD
+        geometry.fieldRaster = make_shared<const Planning::ObstacleRaster>(obstacle_list, DISTANCE_FIELD_CELL);
+    #endif
+    return geometry;
+}
 
-        // extract minimum rectangle enclosing the number
-        cv::findContours(processROI, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
-        minRect[i] = minAreaRect(cv::Mat(contours[0]));
+/** Starts computing the obstacle geometry on a background thread.
+ * The planner waits for it only when it needs it (see obstacleGeometryFor).
+ * @param obstacle_list List of obstacle polygons.
+*/
+void prepareObstacleGeometry(const vector<Polygon>& obstacle_list) {
+    lock_guard<mutex> lock(obstacleGeometryMutex);
+    obstacleGeometry = async(launch::async, computeObstacleGeometry, obstacle_list).share();
+}
 
-        // rotate min rectangle to align with axes
-        cv::Mat rotM = cv::getRotationMatrix2D(minRect[i].center, minRect[i].angle, 1.0);
-        cv::warpAffine(processROI, processROI, rotM, processROI.size(), cv::INTER_CUBIC);
-        cv::bitwise_not(processROI, processROI);
-        cv::cvtColor(processROI, processROI, cv::COLOR_GRAY2BGR);
+/** Gets the geometry of a set of obstacles.
+ * Returns the precomputed geometry if it was prepared for the same
+ * obstacles, otherwise computes it (and keeps it for the next calls).
+ * @param obstacle_list List of obstacle polygons.
+ * @return The obstacle geometry (get() waits until it is ready).
+*/
+shared_future<ObstacleGeometry> obstacleGeometryFor(const vector<Polygon>& obstacle_list) {
+    lock_guard<mutex> lock(obstacleGeometryMutex);
+    if (!obstacleGeometry.valid() ||
+        !PUtils::polygonsEqual(obstacleGeometry.get().obstacles, obstacle_list)) {
+        promise<ObstacleGeometry> computed;
+        computed.set_value(computeObstacleGeometry(obstacle_list));
+        obstacleGeometry = computed.get_future().share();
+    }
+    return obstacleGeometry;
+}
 
-        // Show the actual image used for the template matching
-        #ifdef DEBUG_FINDVICTIMS
-            cv::imshow("ROI", processROI);
-        #endif
+/** Updates the last processed map with the arena regions that changed.
+ * The changed regions are grown until they contain whole objects: every
+ * cached object they overlap and every object found on their borders, plus
+ * the obstacle dilation. Objects are detected again inside the regions only,
+ * cached objects outside them are kept.
+ * @param img_in Input image.
+ * @param hsv_img HSV input image.
+ * @param scale Scaling factor.
+ * @param color_config Color bounds configuration.
+ * @param config_folder Configuration folder path.
+ * @param previous Last processed map.
+ * @param obstacle_list List of output obstacle polygons.
+ * @param victim_list List of output victim polygons.
+ * @param gate Polygon that represents the gate.
+ * @param areas Output reprocessed regions (empty if nothing changed).
+ * @return False if too much of the arena changed and the whole map has to be processed.
+*/
+bool updateMap(const cv::Mat& img_in, const cv::Mat& hsv_img, const double scale,
+               const Color_config& color_config, const string& config_folder,
+               const MapCache::Snapshot& previous,
+               vector<Polygon>& obstacle_list,
+               vector<pair<int,Polygon>>& victim_list,
+               Polygon& gate, vector<cv::Rect>& areas) {
+    const cv::Rect frame(cv::Point(0, 0), img_in.size());
+    areas = MapCache::changedRegions(previous.image, img_in, MAP_CHANGE_PIXEL_THRESHOLD,
+                                     MAP_CHANGE_CELL_SIZE, MAP_CHANGE_CELL_FRACTION);
+
+    // objects that must not be cut by an area
+    vector<cv::Rect> boxes;
+    for (const Polygon& obstacle : previous.obstacles)
+        boxes.push_back(MapCache::pixelBox(obstacle, scale));
+    for (const auto& victim : previous.victims)
+        boxes.push_back(MapCache::pixelBox(victim.second, scale));
+    if (!previous.gate.empty())
+        boxes.push_back(MapCache::pixelBox(previous.gate, scale));
+
+    vector<Polygon> new_obstacles;
+    vector<pair<int,Polygon>> new_victims;
+    Polygon new_gate;
+    for (int it = 0; !areas.empty(); ++it) {
+        MapCache::growRegions(areas, boxes, obstacleDilation(scale) + 1, frame);
+        if ((it == MAP_CHANGE_MAX_ITERATIONS) ||
+            (MapCache::totalArea(areas) > MAP_CHANGE_MAX_FRACTION * frame.area()))
+            return false;
 
-        // Find the template digit with the best matching
-        double maxScore = 0;
-        int maxIdx = -1;
-        for (size_t j = 0; j < templROIs.size(); ++j) {
-            cv::Mat result;
-            cv::matchTemplate(processROI, templROIs[j], result, cv::TM_CCOEFF);
-            double score;
-            cv::minMaxLoc(result, nullptr, &score);
-            if (score > maxScore) {
-                maxScore = score;
-                maxIdx = floor(j/4);
+        new_obstacles.clear();
+        new_victims.clear();
+        new_gate.clear();
+        findGate(hsv_img, scale, new_gate, color_config, areas);
+        findObstacles(hsv_img, scale, new_obstacles, color_config, areas);
+        findVictims(hsv_img, scale, new_victims, color_config, config_folder, areas);
+
+        // objects on an area border may continue outside: grow and search again
+        bool cut = false;
+        auto checkCut = [&](const Polygon& polygon) {
+            const cv::Rect box = MapCache::pixelBox(polygon, scale);
+            if (!MapCache::inside(box, areas, frame)) {
+                boxes.push_back(box);
+                cut = true;
             }
-        }
+        };
+        for (const Polygon& obstacle : new_obstacles)
+            checkCut(obstacle);
+        for (const auto& victim : new_victims)
+            checkCut(victim.second);
+        if (!new_gate.empty())
+            checkCut(new_gate);
+        if (!cut)
+            break;
+    }
 
-        if (maxIdx != -1) {
-            victim_list.push_back({maxIdx, polygonsFound[i]});
-        }
+    // cached objects outside the areas, then the new ones
+    for (const Polygon& obstacle : previous.obstacles)
+        if (!MapCache::overlaps(MapCache::pixelBox(obstacle, scale), areas))
+            obstacle_list.push_back(obstacle);
+    obstacle_list.insert(obstacle_list.end(), new_obstacles.begin(), new_obstacles.end());
 
-        cout << "Best fitting template: " << ((maxIdx==-1) ? "None (rejected)" : to_string(maxIdx)) << " coordinates: (" << PUtils::baricenter(polygonsFound[i]).x << "," << PUtils::baricenter(polygonsFound[i]).y << ")" << endl;
+    for (const auto& victim : previous.victims)
+        if (!MapCache::overlaps(MapCache::pixelBox(victim.second, scale), areas))
+            victim_list.push_back(victim);
+    victim_list.insert(victim_list.end(), new_victims.begin(), new_victims.end());
 
-        #ifdef DEBUG_FINDVICTIMS
-            cv::waitKey(0);
-        #endif
-    }
+    // there is one gate: a gate found in the areas replaces the cached one
+    if (!new_gate.empty())
+        gate = new_gate;
+    else if (!MapCache::overlaps(MapCache::pixelBox(previous.gate, scale), areas))
+        gate = previous.gate;
 
     return true;
 }
 
+/** Key of everything the map detection depends on besides the image.
+ * A cached map processed with a different key is not reused.
+ * @param config_folder Configuration folder path.
+ * @return Key of color configuration, digit templates and detection parameters.
+*/
+uint64_t mapConfigKey(const string& config_folder) {
+    uint64_t key = MapCache::addFileToKey(MapCache::KEY_SEED, config_folder + COLOR_CONFIG_FILE);
+    for (int i = 0; i <= 5; ++i)
+        key = MapCache::addFileToKey(key, config_folder + "/../imgs/template/" + to_string(i) + ".png");
+    key = MapCache::addValueToKey(key, OBSTACLE_DILATION_SHAPE);
+    key = MapCache::addValueToKey(key, ROBOT_RADIUS);
+    key = MapCache::addValueToKey(key, DETECTION_PYRAMID_LEVELS);
+    #ifdef RLE_MASKS
+        key = MapCache::addValueToKey(key, true);
+    #endif
+    return key;
+}
+
 /** Initiates the map processing starting from an image of the arena.
  * Converts the input image in HSV space for better color detection and
  * calls the functions that detect gate, obstacles and victims.
+ * With MAP_CHANGE_DETECTION, the image is compared with the last processed
+ * map (stored in the configuration folder) and only the changed regions are
+ * processed again (see updateMap).
+ * The planning geometry that depends on the obstacles only (inflation,
+ * obstacle visibility of the visibility graph, obstacle cells of the distance
+ * fields) is computed on a background thread; with
+ * OVERLAPPED_MAP_PREPROCESSING it starts right after the obstacles are found,
+ * concurrently with the digit recognition. planPath then only merges in the
+ * arena borders (see ObstacleGeometry).
  * @param img_in Input image.
  * @param scale Scaling factor.
  * @param obstacle_list List of output obstacle polygons.
@@ -734,20 +1562,508 @@ bool processMap(const cv::Mat& img_in, const double scale,
                 vector<pair<int,Polygon>>& victim_list,
                 Polygon& gate, const string& config_folder) {
 
+    #ifdef DEBUG_MAP_LATENCY
+        auto map_start = chrono::steady_clock::now();
+    #endif
+
     // Convert to HSV for better color detection
     cv::Mat img_hsv;
     cv::cvtColor(img_in, img_hsv, cv::COLOR_BGR2HSV);
 
     Color_config color_config = read_colors(config_folder);
 
-    findGate(img_hsv, scale, gate,color_config);
-    findObstacles(img_hsv, scale, obstacle_list,color_config);
-    findVictims(img_hsv, scale, victim_list, color_config, config_folder);
+    bool updated = false;
+    bool geometry_started = false;
+    #ifdef MAP_CHANGE_DETECTION
+        #ifdef DEBUG_MAP_CHANGES
+            auto update_start = chrono::steady_clock::now();
+        #endif
+        MapCache::Snapshot snapshot;
+        snapshot.configKey = mapConfigKey(config_folder);
+        MapCache::Snapshot previous;
+        vector<cv::Rect> changed;
+        if (MapCache::load(config_folder + MAP_CACHE_IMAGE_FILE, config_folder + MAP_CACHE_FILE, previous) &&
+            (previous.scale == scale) && (previous.configKey == snapshot.configKey)) {
+            updated = updateMap(img_in, img_hsv, scale, color_config, config_folder, previous,
+                                obstacle_list, victim_list, gate, changed);
+            #ifdef DEBUG_MAP_CHANGES
+                for (const cv::Rect& area : changed)
+                    cout << "Changed arena region " << area << endl;
+                cout << "Map update " << (updated ? "done" : "failed, processing the whole map") << " in "
+                     << chrono::duration<double, milli>(chrono::steady_clock::now() - update_start).count()
+                     << " ms" << endl;
+            #endif
+        }
+    #endif
+
+    if (!updated) {
+        const vector<cv::Rect> frame = {cv::Rect(cv::Point(0, 0), img_in.size())};
+        findGate(img_hsv, scale, gate, color_config, frame);
+        findObstacles(img_hsv, scale, obstacle_list, color_config, frame);
+        #ifdef DEBUG_MAP_LATENCY
+            auto obstacles_end = chrono::steady_clock::now();
+            cout << "Map latency: gate and obstacles "
+                 << chrono::duration<double, milli>(obstacles_end - map_start).count() << " ms" << endl;
+        #endif
+        #ifdef OVERLAPPED_MAP_PREPROCESSING
+            // the obstacle geometry does not depend on the victims
+            prepareObstacleGeometry(obstacle_list);
+            geometry_started = true;
+        #endif
+        findVictims(img_hsv, scale, victim_list, color_config, config_folder, frame);
+        #ifdef DEBUG_MAP_LATENCY
+            cout << "Map latency: victims "
+                 << chrono::duration<double, milli>(chrono::steady_clock::now() - obstacles_end).count()
+                 << " ms" << endl;
+        #endif
+    }
+    if (!geometry_started)
+        prepareObstacleGeometry(obstacle_list);
+
+    #ifdef MAP_CHANGE_DETECTION
+        // the stored map stays the reference while nothing changes
+        // (and, without MAP_CACHE_REFRESH, until the whole map is processed again)
+        if (!updated || (MAP_CACHE_REFRESH && !changed.empty())) {
+            snapshot.image = img_in;
+            snapshot.scale = scale;
+            snapshot.obstacles = obstacle_list;
+            snapshot.victims = victim_list;
+            snapshot.gate = gate;
+            MapCache::save(config_folder + MAP_CACHE_IMAGE_FILE, config_folder + MAP_CACHE_FILE, snapshot);
+        }
+    #endif
+
+    #ifdef DEBUG_MAP_LATENCY
+        // time until the obstacle geometry is ready
+        {
+            shared_future<ObstacleGeometry> geometry;
+            {
+                lock_guard<mutex> lock(obstacleGeometryMutex);
+                geometry = obstacleGeometry;
+            }
+            geometry.wait();
+        }
+        cout << "Map latency: obstacle geometry ready after "
+             << chrono::duration<double, milli>(chrono::steady_clock::now() - map_start).count()
+             << " ms" << endl;
+    #endif
+
+    mapProcessed = true;
+    return true;
+}
+
+/** Segments the robot triangle in an image.
+ * Extracts the blue region and approximates its contours, looking for a
+ * triangle.
+ * @param img_in BGR input image.
+ * @param color_config Color bounds configuration.
+ * @param robot_curve Output triangle vertices (pixels).
+ * @return True if a triangle was found.
+*/
+bool segmentRobotTriangle(const cv::Mat& img_in, const Color_config& color_config,
+                          vector<cv::Point>& robot_curve) {
+    // Convert color space from BGR to HSV
+    cv::Mat hsv_img;
+    cv::cvtColor(img_in, hsv_img, cv::COLOR_BGR2HSV);
+
+    // Extract blue color region
+    auto t = color_config.robot_lowbound;
+    int lowH = get<0>(t);
+    int lowS = get<1>(t);
+    int lowV = get<2>(t);
+    t = color_config.robot_highbound;
+    int highH = get<0>(t);
+    int highS = get<1>(t);
+    int highV = get<2>(t);
+
+    #ifdef DEBUG_COLOR_RANGE
+        printf("Using BLUE bound  (%d,%d,%d)-(%d,%d,%d)\n", lowH, lowS, lowV, highH, highS, highV);
+    #endif
+    cv::Mat blue_mask;
+    cv::inRange(hsv_img, cv::Scalar(lowH, lowS, lowV), cv::Scalar(highH, highS, highV), blue_mask);
+
+    // remove noise with opening operation
+    //cv::morphologyEx(blue_mask, blue_mask, cv::MORPH_OPEN, cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(5,5)));
+
+    // find robot contours and approximate to triangle
+    vector<vector<cv::Point>> contours;
+    cv::findContours(blue_mask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+
+    #ifdef DEBUG_FINDROBOT
+        cv::Mat contours_img;
+        contours_img = img_in.clone();
+    #endif
+
+    vector<cv::Point> approx_curve;
+    vector<vector<cv::Point>> contours_approx;
+    bool found = false;
+    for (size_t i = 0; i<contours.size(); ++i) {
+        // Approximate the i-th contours
+        cv::approxPolyDP(contours[i], approx_curve, 10, true);
+
+        // Check the number of edge of the aproximated contour
+        if (approx_curve.size() != 3) continue;
+
+        // draw approximated contours
+        #ifdef DEBUG_FINDROBOT
+            //cout << "Approx contour count: " << approx_curve.size() << endl;
+            contours_approx = {approx_curve};
+            cv::drawContours(contours_img, contours_approx, -1, cv::Scalar(0,0,255), 1, cv::LINE_AA);
+
+            showDebugImage("findRobot", contours_img);
+        #endif
+        robot_curve = approx_curve;
+        found = true;
+    }
+
+    return found;
+}
+
+/** Segments the robot triangle in the whole frame, coarse-to-fine.
+ * With DETECTION_PYRAMID_LEVELS > 0 the blue blobs are located on a decimated
+ * frame and the triangle is segmented only inside their full resolution ROIs.
+ * @param img_in BGR input image.
+ * @param color_config Color bounds configuration.
+ * @param robot_curve Output triangle vertices (pixels).
+ * @return True if a triangle was found.
+*/
+bool searchRobotTriangle(const cv::Mat& img_in, const Color_config& color_config,
+                         vector<cv::Point>& robot_curve) {
+    if (DETECTION_PYRAMID_LEVELS <= 0)
+        return segmentRobotTriangle(img_in, color_config, robot_curve);
+
+    auto lt = color_config.robot_lowbound;
+    auto ht = color_config.robot_highbound;
+    const vector<CoarseDetection::ColorRange> blue_ranges = {
+        make_pair(cv::Scalar(get<0>(lt), get<1>(lt), get<2>(lt)),
+                  cv::Scalar(get<0>(ht), get<1>(ht), get<2>(ht)))
+    };
+
+    // only the decimated frame is converted to HSV here
+    cv::Mat coarse;
+    CoarseDetection::downsample(img_in, DETECTION_PYRAMID_LEVELS, coarse);
+    cv::cvtColor(coarse, coarse, cv::COLOR_BGR2HSV);
+    vector<cv::Rect> rois = CoarseDetection::coarseBlobROIs(coarse, blue_ranges,
+                                                            DETECTION_PYRAMID_LEVELS,
+                                                            2, img_in.size());
+
+    bool found = false;
+    vector<cv::Point> roi_curve;
+    for (const cv::Rect& roi : rois) {
+        if (segmentRobotTriangle(img_in(roi), color_config, roi_curve)) {
+            for (cv::Point& pt : roi_curve)
+                pt += roi.tl();
+            robot_curve = roi_curve;
+            found = true;
+        }
+    }
+    return found;
+}
+
+/** Segments the robot triangle searching near its last known position.
+ * The search window is centered on the last baricenter and sized by the
+ * triangle size plus the distance the robot can travel (ROBOT_MAX_SPEED) in
+ * the time elapsed since the last detection. If the triangle is not found
+ * completely inside the window, or the last pose is stale, the whole frame
+ * is searched.
+ * @param img_in BGR input image.
+ * @param scale Scaling factor (pixels per meter).
+ * @param color_config Color bounds configuration.
+ * @param tracker Tracking state, updated with the result.
+ * @param robot_curve Output triangle vertices (pixels).
+ * @return True if a triangle was found.
+*/
+bool trackRobotTriangle(const cv::Mat& img_in, const double scale,
+                        const Color_config& color_config, RobotTracker& tracker,
+                        vector<cv::Point>& robot_curve) {
+    const chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    bool found = false;
+
+    #ifdef ROBOT_TRACKING
+        const double dt = chrono::duration<double>(now - tracker.stamp).count();
+        if (tracker.valid && (dt <= ROBOT_TRACKING_MAX_INTERVAL)) {
+            const float reach = tracker.radius + (ROBOT_MAX_SPEED * dt + ROBOT_TRACKING_MARGIN) * scale;
+            cv::Rect window(cvFloor(tracker.center.x - reach), cvFloor(tracker.center.y - reach),
+                            cvCeil(2 * reach), cvCeil(2 * reach));
+            window &= cv::Rect(0, 0, img_in.cols, img_in.rows);
+
+            if (window.area() > 0 &&
+                segmentRobotTriangle(img_in(window), color_config, robot_curve)) {
+                for (cv::Point& pt : robot_curve)
+                    pt += window.tl();
+                // A triangle touching a window side that cuts the frame may
+                // be truncated: in that case search the whole frame
+                cv::Rect box = cv::boundingRect(robot_curve);
+                const bool truncated =
+                    ((box.x <= window.x) && (window.x > 0)) ||
+                    ((box.y <= window.y) && (window.y > 0)) ||
+                    ((box.br().x >= window.br().x) && (window.br().x < img_in.cols)) ||
+                    ((box.br().y >= window.br().y) && (window.br().y < img_in.rows));
+                found = !truncated;
+            }
+            #ifdef DEBUG_FINDROBOT
+                cout << "Robot tracking window " << window << (found ? " hit" : " missed") << endl;
+            #endif
+        }
+    #endif
+
+    if (!found) // full-frame fallback
+        found = searchRobotTriangle(img_in, color_config, robot_curve);
+
+    tracker.valid = found;
+    if (found) {
+        cv::Point2f center(0, 0);
+        for (const cv::Point& pt : robot_curve)
+            center += cv::Point2f(pt.x, pt.y);
+        center *= 1.0f / robot_curve.size();
+        float radius = 0;
+        for (const cv::Point& pt : robot_curve)
+            radius = max(radius, (float)cv::norm(cv::Point2f(pt.x, pt.y) - center));
+        tracker.center = center;
+        tracker.radius = radius;
+        tracker.stamp = now;
+    }
+    return found;
+}
+
+/** Computes the robot pose from the robot triangle.
+ * The position is the baricenter of the triangle, the orientation is the
+ * direction of the height relative to the base (from the top vertex to the
+ * baricenter).
+ * @param triangle Triangular polygon representing the robot (meters).
+ * @param x Output robot position x coordinate.
+ * @param y Output robot position y coordinate.
+ * @param theta Output robot angle.
+ * @return The top vertex of the triangle.
+*/
+Point robotPoseFromTriangle(const Polygon& triangle, double& x, double& y,
+                            double& theta) {
+    // Find the position of the robot (baricenter of the triangle)
+    double cx = 0, cy = 0;
+
+    // Compute the triangle baricenter
+    PUtils::baricenter(triangle,cx,cy);
+
+    // Find the robot orientation (i.e the angle of height relative to the base with the x axis)
+    double dst = 0;
+    Point top_vertex;
+    for (auto& vertex: triangle) {
+        const double dx = vertex.x-cx;
+        const double dy = vertex.y-cy;
+        const double curr_d = dx*dx + dy*dy;
+        if (curr_d > dst) {
+            dst = curr_d;
+            top_vertex = vertex;
+        }
+    }
+
+    // Store the position of the robot in the output
+    x = cx;
+    y = cy;
+
+    // Compute the robot orientation
+    const double dx = cx - top_vertex.x;
+    const double dy = cy - top_vertex.y;
+    theta = atan2(dy, dx);
+
+    return top_vertex;
+}
+
+/** Compares point-level localization with full-frame localization.
+ * Rectifies the whole raw frame, runs the regular segmentation on it and
+ * checks that the two poses agree within POINT_LOCALIZATION_POS_TOLERANCE
+ * and POINT_LOCALIZATION_ANGLE_TOLERANCE.
+ * @param raw_img Raw input image.
+ * @param scale Scaling factor.
+ * @param x Point-level x coordinate.
+ * @param y Point-level y coordinate.
+ * @param theta Point-level angle.
+ * @param config_folder Configuration folder path.
+ * @return True if the poses agree (or the reference cannot be computed).
+*/
+bool checkPointLocalization(const cv::Mat& raw_img, const double scale,
+                            double x, double y, double theta,
+                            const string& config_folder) {
+    cv::Mat rectified;
+    rectification.rectify(raw_img, rectified, rectification.planeTransform());
+
+    vector<cv::Point> approx_curve;
+    if (!segmentRobotTriangle(rectified, read_colors(config_folder), approx_curve)) {
+        cout << "Point localization check: robot not found in the rectified frame" << endl;
+        return true;
+    }
+    Polygon reference;
+    for (const auto& pt: approx_curve)
+        reference.emplace_back(pt.x/scale, pt.y/scale);
+    double rx, ry, rtheta;
+    robotPoseFromTriangle(reference, rx, ry, rtheta);
+
+    const double position_error = sqrt(pow(x-rx,2) + pow(y-ry,2));
+    const double angle_error = abs(atan2(sin(theta-rtheta), cos(theta-rtheta)));
+    const bool ok = (position_error <= POINT_LOCALIZATION_POS_TOLERANCE) &&
+                    (angle_error <= POINT_LOCALIZATION_ANGLE_TOLERANCE);
+    cout << "Point localization check: position error " << position_error
+         << " m, angle error " << angle_error*180/M_PI << " deg"
+         << (ok ? "" : " (OUT OF TOLERANCE)") << endl;
+    return ok;
+}
+
+/** Maps robot triangle vertices from the raw frame to the arena.
+ * raw pixels -> undistorted pixels -> unwarped (arena) pixels -> meters
+ * @param raw_curve Triangle vertices in the raw frame (pixels).
+ * @param cache Rectification parameters.
+ * @param scale Scaling factor.
+ * @param triangle Output triangle (meters).
+*/
+void rawTriangleToArena(const vector<cv::Point>& raw_curve,
+                        const Rectification::RemapCache& cache,
+                        const double scale, Polygon& triangle) {
+    vector<cv::Point2f> raw_vertices(raw_curve.begin(), raw_curve.end());
+    vector<cv::Point2f> undistorted_vertices, arena_vertices;
+    cv::undistortPoints(raw_vertices, undistorted_vertices,
+                        cache.cameraMatrix(), cache.distCoeffs(),
+                        cv::noArray(), cache.cameraMatrix());
+    cv::perspectiveTransform(undistorted_vertices, arena_vertices,
+                             cache.planeTransform());
+
+    for (const auto& pt: arena_vertices) {
+        triangle.emplace_back(pt.x/scale, pt.y/scale);
+    }
+}
+
+/** Finds the robot on a raw (distorted, not unwarped) camera frame.
+ * The robot triangle is segmented on the raw frame and only its three
+ * vertices are undistorted (cv::undistortPoints) and mapped with the plane
+ * transform, so no full-frame resampling is needed for localization.
+ * The pose is then computed on the mapped vertices, as findRobot does on the
+ * rectified image (the baricenter is not preserved by the homography, so it
+ * is computed after the mapping).
+ * Calibration parameters are the ones cached by imageUndistort and
+ * findPlaneTransform.
+ * @param img_in Raw input image.
+ * @param scale Scaling factor.
+ * @param triangle Triangular polygon representing the robot.
+ * @param x Robot position x coordinate.
+ * @param y Robot position y coordinate.
+ * @param theta Robot position angle.
+ * @param config_folder Configuration folder path.
+ * @return True if robot was found.
+*/
+bool findRobotRaw(const cv::Mat& img_in, const double scale, Polygon& triangle,
+                  double& x, double& y, double& theta,
+                  const string& config_folder) {
+    if (!rectification.canFuse())
+        throw logic_error("findRobotRaw: camera calibration is not available");
+
+    Color_config color_config = read_colors(config_folder);
+
+    vector<cv::Point> approx_curve;
+    if (!trackRobotTriangle(img_in, scale, color_config, rawTracker, approx_curve))
+        return false;
+
+    rawTriangleToArena(approx_curve, rectification, scale, triangle);
+
+    robotPoseFromTriangle(triangle, x, y, theta);
+
+    #ifdef DEBUG_POINT_LOCALIZATION
+        checkPointLocalization(img_in, scale, x, y, theta, config_folder);
+    #endif
+
+    return true;
+}
+
+/** Starts the localization pipeline.
+ * Stages own copies of the calibration, color configuration and tracking
+ * state, so nothing is shared with the caller thread:
+ * - rectify: fused undistortion + unwarping (skipped with ROBOT_POINT_LOCALIZATION);
+ * - detect: robot triangle segmentation and pose.
+ * @param scale Scaling factor.
+ * @param config_folder Configuration folder path.
+*/
+void startLocalizationPipeline(const double scale, const string& config_folder) {
+    typedef CameraPipeline::Pipeline<LocalizationFrame> LocalizationPipeline;
+
+    shared_ptr<Rectification::RemapCache> cache = make_shared<Rectification::RemapCache>();
+    cache->setIntrinsics(rectification.cameraMatrix(), rectification.distCoeffs());
+    cache->setPlaneTransform(rectification.planeTransform());
+    shared_ptr<RobotTracker> tracker = make_shared<RobotTracker>();
+    const Color_config color_config = read_colors(config_folder);
+
+    vector<pair<string, LocalizationPipeline::Stage>> stages;
+    #ifndef ROBOT_POINT_LOCALIZATION
+        stages.emplace_back("rectify", [cache](LocalizationFrame& f) -> bool {
+            cv::Mat rectified;
+            cache->rectify(f.image, rectified, cache->planeTransform());
+            f.image = rectified;
+            return true;
+        });
+    #endif
+    stages.emplace_back("detect", [cache, tracker, color_config, scale](LocalizationFrame& f) -> bool {
+        if (!trackRobotTriangle(f.image, scale, color_config, *tracker, f.curve))
+            return false;
+        #ifdef ROBOT_POINT_LOCALIZATION
+            rawTriangleToArena(f.curve, *cache, scale, f.triangle);
+        #else
+            for (const auto& pt: f.curve) {
+                f.triangle.emplace_back(pt.x/scale, pt.y/scale);
+            }
+        #endif
+        robotPoseFromTriangle(f.triangle, f.x, f.y, f.theta);
+        f.image.release();  // only the pose is published
+        return true;
+    });
+
+    localizationPipeline.reset(new LocalizationPipeline(stages));
+}
+
+/** Reads the robot pose computed by the localization pipeline.
+ * Waits at most PIPELINE_POSE_TIMEOUT_MS for a pose at most
+ * PIPELINE_MAX_POSE_AGE frames older than the last captured frame.
+ * @param triangle Triangular polygon representing the robot.
+ * @param x Robot position x coordinate.
+ * @param y Robot position y coordinate.
+ * @param theta Robot position angle.
+ * @return True if a fresh pose is available.
+*/
+bool pipelinedRobotPose(Polygon& triangle, double& x, double& y, double& theta) {
+    const uint64_t pushed = localizationPipeline->lastPushed();
+    const uint64_t oldest = (pushed > PIPELINE_MAX_POSE_AGE) ? pushed - PIPELINE_MAX_POSE_AGE : 1;
+
+    LocalizationFrame frame;
+    const uint64_t seq = localizationPipeline->waitNewer(frame, oldest - 1,
+                                                         chrono::milliseconds(PIPELINE_POSE_TIMEOUT_MS));
+
+    #ifdef DEBUG_PIPELINE
+        if (pushed % PIPELINE_STATS_PERIOD == 0) {
+            CameraPipeline::PipelineStats st = localizationPipeline->stats();
+            printf("Pipeline: %lu pushed, %lu published, latency %.2f ms (max %.2f ms)\n",
+                   (unsigned long)st.pushed, (unsigned long)st.published,
+                   st.meanLatencyMs, st.maxLatencyMs);
+            for (const CameraPipeline::StageStats& stage : st.stages) {
+                printf("  %-8s %lu processed, %lu replaced, %lu dropped, %.2f ms (max %.2f ms)\n",
+                       stage.name.c_str(), (unsigned long)stage.processed, (unsigned long)stage.replaced,
+                       (unsigned long)stage.dropped, stage.meanMs, stage.maxMs);
+            }
+        }
+    #endif
+
+    if (seq < oldest)
+        return false;   // robot lost or pipeline behind
 
+    triangle = frame.triangle;
+    x = frame.x;
+    y = frame.y;
+    theta = frame.theta;
     return true;
 }
 
 /** Finds the robot in the arena given the arena image.
+ * With PIPELINED_LOCALIZATION, after the first synchronous localization the
+ * pose is computed by the pipeline threads (see startLocalizationPipeline).
+ * With ROBOT_TRACKING the robot is searched only in a window around its last
+ * position (see trackRobotTriangle).
+ * With ROBOT_POINT_LOCALIZATION, for images forwarded by unwarp the raw
+ * frame they were undistorted from is handled by findRobotRaw.
  * @param img_in Input image.
  * @param scale Scaling factor.
  * @param triangle Triangular polygon representing the robot.
@@ -760,62 +2076,28 @@ bool processMap(const cv::Mat& img_in, const double scale,
 bool findRobot(const cv::Mat& img_in, const double scale, Polygon& triangle,
                double& x, double& y, double& theta,
                const string& config_folder) {
-    Color_config color_config = read_colors(config_folder);
-
-    // Convert color space from BGR to HSV
-    cv::Mat hsv_img;
-    cv::cvtColor(img_in, hsv_img, cv::COLOR_BGR2HSV);
-
-    // Extract blue color region
-    auto t = color_config.robot_lowbound;
-    int lowH = get<0>(t);
-    int lowS = get<1>(t);
-    int lowV = get<2>(t);
-    t = color_config.robot_highbound;
-    int highH = get<0>(t);
-    int highS = get<1>(t);
-    int highV = get<2>(t);
-
-    #ifdef DEBUG_COLOR_RANGE
-        printf("Using BLUE bound  (%d,%d,%d)-(%d,%d,%d)\n", lowH, lowS, lowV, highH, highS, highV);
+    #ifdef PIPELINED_LOCALIZATION
+        if (localizationPipeline && !rectification.sourceOf(img_in).empty())
+            return pipelinedRobotPose(triangle, x, y, theta);
+        if (!localizationPipeline && mapProcessed && rectification.canFuse())
+            startLocalizationPipeline(scale, config_folder); // from the next frame on
+    #endif
+    #ifdef ROBOT_POINT_LOCALIZATION
+        const cv::Mat raw = rectification.sourceOf(img_in);
+        if (!raw.empty())
+            return findRobotRaw(raw, scale, triangle, x, y, theta, config_folder);
     #endif
-    cv::Mat blue_mask;
-    cv::inRange(hsv_img, cv::Scalar(lowH, lowS, lowV), cv::Scalar(highH, highS, highV), blue_mask);
 
-    // remove noise with opening operation
-    //cv::morphologyEx(blue_mask, blue_mask, cv::MORPH_OPEN, cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(5,5)));
+    Color_config color_config = read_colors(config_folder);
 
-    // find robot contours and approximate to triangle
-    vector<vector<cv::Point>> contours;
-    cv::findContours(blue_mask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    vector<cv::Point> approx_curve;
+    bool found = trackRobotTriangle(img_in, scale, color_config, rectifiedTracker, approx_curve);
 
     #ifdef DEBUG_FINDROBOT
         cv::Mat contours_img;
         contours_img = img_in.clone();
     #endif
 
-    vector<cv::Point> approx_curve;
-    vector<vector<cv::Point>> contours_approx;
-    bool found = false;
-    for (size_t i = 0; i<contours.size(); ++i) {
-        // Approximate the i-th contours
-        cv::approxPolyDP(contours[i], approx_curve, 10, true);
-
-        // Check the number of edge of the aproximated contour
-        if (approx_curve.size() != 3) continue;
-
-        // draw approximated contours
-        #ifdef DEBUG_FINDROBOT
-            //cout << "Approx contour count: " << approx_curve.size() << endl;
-            contours_approx = {approx_curve};
-            cv::drawContours(contours_img, contours_approx, -1, cv::Scalar(0,0,255), 1, cv::LINE_AA);
-
-            cv::imshow("findRobot", contours_img);
-            cv::waitKey(0);
-        #endif
-        found = true;
-    }
-
     // set robot position
     if (found) {
         // emplace back every vertex on triangle (output of this function)
@@ -825,33 +2107,7 @@ bool findRobot(const cv::Mat& img_in, const double scale, Polygon& triangle,
             // (pixels) to the position in the arena (meters)
         }
 
-        // Find the position of the robot (baricenter of the triangle)
-        double cx = 0, cy = 0;
-
-        // Compute the triangle baricenter
-        PUtils::baricenter(triangle,cx,cy);
-
-        // Find the robot orientation (i.e the angle of height relative to the base with the x axis)
-        double dst = 0;
-        Point top_vertex;
-        for (auto& vertex: triangle) {
-            const double dx = vertex.x-cx;
-            const double dy = vertex.y-cy;
-            const double curr_d = dx*dx + dy*dy;
-            if (curr_d > dst) {
-                dst = curr_d;
-                top_vertex = vertex;
-            }
-        }
-
-        // Store the position of the robot in the output
-        x = cx;
-        y = cy;
-
-        // Compute the robot orientation
-        const double dx = cx - top_vertex.x;
-        const double dy = cy - top_vertex.y;
-        theta = atan2(dy, dx);
+        Point top_vertex = robotPoseFromTriangle(triangle, x, y, theta);
 
         cv::Point cv_center(x*scale, y*scale); // convert back m to px
         cv::Point cv_vertex(top_vertex.x*scale, top_vertex.y*scale); // convert back m to px
@@ -865,8 +2121,7 @@ bool findRobot(const cv::Mat& img_in, const double scale, Polygon& triangle,
     }
 
     #ifdef DEBUG_FINDROBOT
-        cv::imshow("findRobot", contours_img);
-        cv::waitKey(0);
+        showDebugImage("findRobot", contours_img);
     #endif
 
     return found;
@@ -1032,8 +2287,7 @@ Polygon cutGateSlot(const Polygon& gate, const Polygon& cBorders, double xf,
             cv::circle(dcImg, cv::Point(bp.x * debugImagesScale, bp.y * debugImagesScale), 5, cv::Scalar(0,0,255), -1);
             cv::putText(dcImg, std::to_string(counter), cv::Point(bp.x*debugImagesScale, bp.y*debugImagesScale), cv::FONT_HERSHEY_DUPLEX, 1.0, cv::Scalar(0,0,0), 2);
         }
-        cv::imshow("CutSlot", dcImg);
-        cv::waitKey(0);
+        showDebugImage("CutSlot", dcImg);
     #endif
 
     return slottedBorders;
@@ -1211,8 +2465,7 @@ bool isDiscretizedArcColliding(dubins::Arc& a, Point pA, Point pB) {
         if (isSegmentColliding(d_arc[j], d_arc[j+1], pA, pB)) {
 
             #ifdef DEBUG_COLLISION
-                cv::imshow("arc pol", img);
-                cv::waitKey(0);
+                showDebugImage("arc pol", img);
             #endif
 
             return true;
@@ -1833,9 +3086,83 @@ bool pathSmoothing(int start_index, int finish_index, vector<Point> vertices,
     }
 }
 
+/** Computes the length of a path of points.
+ * @param path Input path points.
+ * @return The legth of the path.
+*/
+float getPointPathLength(const vector<Point>& path){
+    float length = 0;
+
+    for (size_t i = 0; i < path.size()-1; i++)
+    {
+        const Point pos1 = path[i];
+        const Point pos2 = path[i+1];
+        length += sqrt(pow((pos1.x - pos2.x), 2) + pow((pos1.y - pos2.y), 2));
+    }
+
+    return length;
+}
+
+/** Reads the path written by the RRT script.
+ * @param file Output file of the script.
+ * @param vertices Output path points.
+ * @return False if the script did not find a path.
+*/
+bool readRRTOutput(const string& file, vector<Point>& vertices) {
+    ifstream input(file);
+    vertices.clear();
+
+    bool path_not_found = false;
+    if (input.is_open()) {
+        string line;
+        while (getline(input,line)) {
+            input >> line;
+            istringstream ss(line);
+            string token;
+
+            float v1 = 0.0, v2 = 0.0;
+            int count = 0;
+
+            while (getline(ss, token, ',')) {
+                if (stoi(token) == -1) {
+                    path_not_found = true;
+                } else {
+                    if (count%2 == 0) {
+                        v1 = stod(token);
+                    } else {
+                        v2 = stod(token);
+                        vertices.push_back(Point(v1/pythonUpscale,v2/pythonUpscale));   //Scaling back points using the scale factor for the library
+                    }
+                    count++;
+                }
+            }
+        }
+    }
+
+    return !path_not_found;
+}
+
+/** Gets the RRT worker process.
+ * It is started on the first call, and started again if it stopped.
+ * @param config_folder Configuration folder path.
+ * @return The worker (kept alive by the caller even if it is replaced meanwhile).
+*/
+shared_ptr<PlannerWorker> plannerWorkerFor(const string& config_folder) {
+    lock_guard<mutex> lock(plannerWorkerMutex);
+    if (!plannerWorker || !plannerWorker->running()) {
+        const string plan_script_lib = config_folder + "/../src/path-planning";
+        plannerWorker.reset(new PlannerWorker({"python", plan_script_lib + "/rrt_worker.py"}, pythonUpscale));
+    }
+    return plannerWorker;
+}
+
 /** Plans the path with RRT.
- * Prepares a file with input data: starting point, arrival point, borders and obstacles.
+ * With PLANNER_WORKER the problem is sent to the persistent RRT worker process (see PlannerWorker).
+ * Otherwise (opt-in racing) prepares a file with input data: starting point, arrival point, borders and obstacles.
  * The RRT library will output another file with the coordinates of the points in the path found.
+ * Every call uses its own temporary files, so calls can run concurrently. RRT_RACERS differently seeded
+ * instances of the library are raced: the first path found is kept (or the shortest one found within
+ * RRT_RACE_DEADLINE) and the other instances are killed.
  * @param borders Borders of the arena.
  * @param obstacle_list List of obstacle polygons.
  * @param x0 Starting point x coordinate.
@@ -1849,21 +3176,34 @@ vector<Point> RRTplanner(const Polygon& borders, const vector<Polygon>& obstacle
                   const float x0, const float y0, const float xf, const float yf,
                   const string& config_folder) {
 
+    #ifdef PLANNER_WORKER
+    // inflated once per map (see prepareObstacleGeometry)
+    shared_future<ObstacleGeometry> geometry = obstacleGeometryFor(obstacle_list);
+    vector<Point> vertices;
+    if (!plannerWorkerFor(config_folder)->plan(borders, geometry.get().inflated, Point(x0,y0), Point(xf,yf), vertices))
+        throw runtime_error("Path not found!");
+    return vertices;
+    #else
     //
     // write the problem parameters to a file that will be fed to a planning lib
     //
 
     const string plan_script_lib = config_folder + "/../src/path-planning";
-    ofstream output(plan_script_lib + "/i.txt");
+    // racers and files are killed and removed on return or on any throw
+    ProcessUtils::ChildGroup racers;
+    const string input_file = racers.temporaryFile("rrt_input_");
+    ofstream output(input_file);
     if (!output.is_open()) {
-        throw runtime_error("Cannot write file: " + plan_script_lib + "/i.txt");
+        throw runtime_error("Cannot write file: " + input_file);
     }
 
     #ifdef DEBUG_RRT
         printf("To avoid approximation errors, obstacles are inflated by %f meters (%f cm)\n",SAFETY_INFLATE_AMOUNT,SAFETY_INFLATE_AMOUNT*100);
     #endif
 
-    vector<Polygon> inflated_obstacle_list = ClipperHelper::inflatePolygons(obstacle_list,SAFETY_INFLATE_AMOUNT);
+    // inflated once per map (see prepareObstacleGeometry)
+    shared_future<ObstacleGeometry> geometry = obstacleGeometryFor(obstacle_list);
+    const vector<Polygon>& inflated_obstacle_list = geometry.get().inflated;
 
     #ifdef DEBUG_RRT
         printf("Writing problem parameters to file\n");
@@ -1903,53 +3243,258 @@ vector<Point> RRTplanner(const Polygon& borders, const vector<Polygon>& obstacle
     // The text file has ben prepared, now the external plan library is called
     //
 
-    // prepare script command
-    string cmd = "python " + plan_script_lib + "/rrt.py -in " + plan_script_lib + "/i.txt -out " + plan_script_lib + "/output.txt";
-    // call library script
-    int state = system(cmd.c_str());
-    if (state != 0)
-        throw std::logic_error("Python script returned bad value");
+    // start the racers, each with its own seed and output file
+    random_device seeder;
+    vector<string> output_files;
+    const unsigned int racer_count = ParallelUtils::workerCount(RRT_RACERS);
+    for (unsigned int i = 0; i < racer_count; ++i) {
+        output_files.push_back(racers.temporaryFile("rrt_output_"));
+        racers.spawn({"python", plan_script_lib + "/rrt.py",
+                      "-in", input_file, "-out", output_files.back(),
+                      "-seed", to_string(seeder())});
+    }
 
     //
-    // Read the resulting path
+    // Wait for the first path (or the shortest one within the deadline)
     //
 
-    // read vertices and path from output.txt
-    ifstream input(plan_script_lib + "/output.txt");
+    auto start = chrono::steady_clock::now();
+    const auto deadline = start + chrono::duration_cast<chrono::steady_clock::duration>(
+                                      chrono::duration<double>(RRT_RACE_DEADLINE));
     vector<Point> vertices;
-
-    bool path_not_found = false;
-    if (input.is_open()) {
-        string line;
-        while (getline(input,line)) {
-            input >> line;
-            istringstream ss(line);
-            string token;
-
-            float v1 = 0.0, v2 = 0.0;
-            int count = 0;
-
-            while (getline(ss, token, ',')) {
-                if (stoi(token) == -1) {
-                    path_not_found = true;
-                } else {
-                    if (count%2 == 0) {
-                        v1 = stod(token);
-                    } else {
-                        v2 = stod(token);
-                        vertices.push_back(Point(v1/pythonUpscale,v2/pythonUpscale));   //Scaling back points using the scale factor for the library
-                    }
-                    count++;
-                }
+    bool path_found = false, bad_exit = false;
+    size_t running = racers.size();
+    while ((running > 0) && !(path_found && chrono::steady_clock::now() >= deadline)) {
+        bool polled = false;    // some racer exited in this round
+        for (size_t i = 0; i < racers.size(); ++i) {
+            int state;
+            if (!racers.running(i) || !racers.exited(i, state))
+                continue;
+            --running;
+            polled = true;
+            vector<Point> racer_vertices;
+            if (state != 0) {
+                bad_exit = true;
+            } else if (readRRTOutput(output_files[i], racer_vertices) && !racer_vertices.empty() &&
+                       (!path_found || (getPointPathLength(racer_vertices) < getPointPathLength(vertices)))) {
+                vertices = racer_vertices;
+                path_found = true;
+                #ifdef DEBUG_RRT
+                    auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+                    printf("RRT racer %zu found a path (length %f) after %ld ms\n", i, getPointPathLength(vertices), (long)elapsed);
+                #endif
             }
         }
+        if (!polled)
+            this_thread::sleep_for(chrono::milliseconds(RRT_RACE_POLL_MS));
     }
 
-    if (path_not_found) {
+    if (!path_found) {
+        if (bad_exit)
+            throw std::logic_error("Python script returned bad value");
         throw runtime_error("Path not found!");
     }
 
     return vertices;
+    #endif
+}
+
+/** Builds a native point planner.
+ * Every backend checks collisions against the obstacles inflated by
+ * SAFETY_INFLATE_AMOUNT, as the RRT script does.
+ * @param backend Planner to build (not PlannerBackend::rrt).
+ * @param borders Borders of the arena.
+ * @param obstacle_list List of obstacle polygons.
+ * @param config_folder Configuration folder path.
+ * @return The planner.
+*/
+unique_ptr<Planning::PointPlanner> buildPointPlanner(PlannerBackend backend, const Polygon& borders,
+                                                     const vector<Polygon>& obstacle_list,
+                                                     const string& config_folder) {
+    // paths keep clear of the inflated obstacles, as the RRT script paths
+    // (inflated once per map, see prepareObstacleGeometry)
+    shared_future<ObstacleGeometry> geometry = obstacleGeometryFor(obstacle_list);
+    const vector<Polygon>& inflated_obstacle_list = geometry.get().inflated;
+    Planning::CollisionChecker checker(borders, inflated_obstacle_list);
+
+    switch (backend) {
+    case PlannerBackend::visibilityGraph: {
+        // graph vertices slightly off the inflated obstacles (with their
+        // visibility, prebuilt for the visibility graph POINT_PLANNER) and the borders
+        shared_ptr<const Planning::ObstacleVisibility> visibility = geometry.get().visibility;
+        if (!visibility)
+            visibility = obstacleVisibility(inflated_obstacle_list);
+        const Polygon innerBorders = ClipperHelper::offsetBorders(borders, -VISIBILITY_VERTEX_MARGIN);
+
+        unique_ptr<Planning::VisibilityGraph> graph(new Planning::VisibilityGraph(checker, *visibility, innerBorders));
+        #ifdef DEBUG_PLANPATH
+            cout << "Visibility graph: " << graph->nodeCount() << " vertices, " << graph->edgeCount() << " edges" << endl;
+        #endif
+        return unique_ptr<Planning::PointPlanner>(move(graph));
+    }
+    case PlannerBackend::cellDecomposition: {
+        unique_ptr<Planning::VerticalCellDecomposition> decomposition(new Planning::VerticalCellDecomposition(checker));
+        #ifdef DEBUG_PLANPATH
+            cout << "Cell decomposition: " << decomposition->cellList().size() << " cells, "
+                 << decomposition->nodeCount() << " roadmap nodes" << endl;
+        #endif
+        return unique_ptr<Planning::PointPlanner>(move(decomposition));
+    }
+    case PlannerBackend::prm: {
+        Planning::ProbabilisticRoadmap::Parameters parameters;
+        parameters.samples = PRM_SAMPLES;
+        parameters.neighbours = PRM_NEIGHBOURS;
+        parameters.seed = PRM_SEED;
+        unique_ptr<Planning::ProbabilisticRoadmap> roadmap(new Planning::ProbabilisticRoadmap(checker, parameters));
+
+        const string cache_path = config_folder + PRM_CACHE_FILE;
+        if (roadmap->load(cache_path)) {
+            #ifdef DEBUG_PLANPATH
+                cout << "Probabilistic roadmap loaded from " << cache_path << endl;
+            #endif
+        } else {
+            roadmap->build();
+            roadmap->save(cache_path);
+        }
+        #ifdef DEBUG_PLANPATH
+            cout << "Probabilistic roadmap: " << roadmap->nodeCount() << " samples, " << roadmap->edgeCount() << " edges" << endl;
+        #endif
+        return unique_ptr<Planning::PointPlanner>(move(roadmap));
+    }
+    case PlannerBackend::rrtStar: {
+        Planning::InformedRRTStar::Parameters parameters;
+        parameters.budget = RRT_STAR_BUDGET;
+        parameters.step = RRT_STAR_STEP;
+        return unique_ptr<Planning::PointPlanner>(new Planning::InformedRRTStar(checker, parameters));
+    }
+    case PlannerBackend::rrtConnect: {
+        Planning::RRTConnect::Parameters parameters;
+        parameters.step = RRT_CONNECT_STEP;
+        parameters.maxIterations = RRT_CONNECT_MAX_ITERATIONS;
+        return unique_ptr<Planning::PointPlanner>(new Planning::RRTConnect(checker, parameters));
+    }
+    default:
+        throw logic_error("Not a native point planner");
+    }
+}
+
+/** Gets the native point planner of a map.
+ * It is rebuilt only when the borders or the obstacles change.
+ * @param borders Borders of the arena.
+ * @param obstacle_list List of obstacle polygons.
+ * @param config_folder Configuration folder path.
+ * @return The planner of the map.
+*/
+Planning::PointPlanner& mapPlannerFor(const Polygon& borders, const vector<Polygon>& obstacle_list,
+                                      const string& config_folder) {
+    if (mapPlanner.planner &&
+        PUtils::polygonsEqual({mapPlanner.borders}, {borders}) &&
+        PUtils::polygonsEqual(mapPlanner.obstacles, obstacle_list))
+        return *mapPlanner.planner;
+
+    auto start = chrono::steady_clock::now();
+
+    mapPlanner.borders = borders;
+    mapPlanner.obstacles = obstacle_list;
+    mapPlanner.planner = buildPointPlanner(POINT_PLANNER, borders, obstacle_list, config_folder);
+
+    #ifdef DEBUG_PLANPATH
+        auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+        cout << "Built " << mapPlanner.planner->name() << " planner in " << elapsed << " ms" << endl;
+    #else
+        (void)start;
+    #endif
+
+    return *mapPlanner.planner;
+}
+
+/** Gets the state lattice of a map.
+ * It is rebuilt only when the borders or the obstacles change.
+ * @param borders Borders of the arena.
+ * @param obstacle_list List of obstacle polygons.
+ * @return The state lattice of the map.
+*/
+Planning::StateLattice& mapLatticeFor(const Polygon& borders, const vector<Polygon>& obstacle_list) {
+    if (mapLattice.lattice &&
+        PUtils::polygonsEqual({mapLattice.borders}, {borders}) &&
+        PUtils::polygonsEqual(mapLattice.obstacles, obstacle_list))
+        return *mapLattice.lattice;
+
+    auto start = chrono::steady_clock::now();
+
+    Planning::StateLattice::Parameters parameters;
+    parameters.kMax = K_MAX;
+    parameters.cell = LATTICE_CELL;
+    parameters.headings = LATTICE_HEADINGS;
+    parameters.primitiveLength = LATTICE_PRIMITIVE_LENGTH;
+    parameters.maxExpansions = LATTICE_MAX_EXPANSIONS;
+    parameters.resolution = PATH_RESOLUTION;
+    mapLattice.borders = borders;
+    mapLattice.obstacles = obstacle_list;
+    mapLattice.lattice.reset(new Planning::StateLattice(Planning::CollisionChecker(borders, obstacle_list), parameters));
+
+    #ifdef DEBUG_PLANPATH
+        auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+        cout << "Built state lattice (" << mapLattice.lattice->primitiveCount() << " primitives) in " << elapsed << " ms" << endl;
+    #else
+        (void)start;
+    #endif
+
+    return *mapLattice.lattice;
+}
+
+#ifdef DEBUG_BENCH_PLANNERS
+/** Compares the native point planners on a query.
+ * Prints build time, query time, sampling iterations and path length.
+ * @param borders Borders of the arena.
+ * @param obstacle_list List of obstacle polygons.
+ * @param start Starting point.
+ * @param goal Arrival point.
+ * @param config_folder Configuration folder path.
+*/
+void benchPointPlanners(const Polygon& borders, const vector<Polygon>& obstacle_list,
+                        const Point& start, const Point& goal, const string& config_folder) {
+    for (PlannerBackend backend : { PlannerBackend::visibilityGraph, PlannerBackend::cellDecomposition,
+                                    PlannerBackend::prm, PlannerBackend::rrtStar, PlannerBackend::rrtConnect }) {
+        auto t0 = chrono::steady_clock::now();
+        unique_ptr<Planning::PointPlanner> planner = buildPointPlanner(backend, borders, obstacle_list, config_folder);
+        auto t1 = chrono::steady_clock::now();
+        try {
+            vector<Point> path = planner->plan(start, goal);
+            auto t2 = chrono::steady_clock::now();
+            float length = 0;
+            for (size_t i = 1; i < path.size(); ++i)
+                length += Planning::distance(path[i-1], path[i]);
+            cout << planner->name() << ": build " << chrono::duration<double, milli>(t1 - t0).count()
+                 << " ms, query " << chrono::duration<double, milli>(t2 - t1).count()
+                 << " ms, " << planner->lastIterations() << " iterations, length " << length << endl;
+        } catch (const runtime_error& e) {
+            cout << planner->name() << ": " << e.what() << endl;
+        }
+    }
+}
+#endif
+
+/** Plans a point path with the planner chosen by POINT_PLANNER.
+ * @param borders Borders of the arena.
+ * @param obstacle_list List of obstacle polygons.
+ * @param x0 Starting point x coordinate.
+ * @param y0 Starting point y coordinate.
+ * @param xf Arrival point x coordinate.
+ * @param yf Arrival point y coordinate.
+ * @param config_folder  Configuration folder path.
+ * @return The planned path.
+*/
+vector<Point> planPointPath(const Polygon& borders, const vector<Polygon>& obstacle_list,
+                  const float x0, const float y0, const float xf, const float yf,
+                  const string& config_folder) {
+    #ifdef DEBUG_BENCH_PLANNERS
+        benchPointPlanners(borders, obstacle_list, Point(x0,y0), Point(xf,yf), config_folder);
+    #endif
+
+    if (POINT_PLANNER == PlannerBackend::rrt)
+        return RRTplanner(borders, obstacle_list, x0, y0, xf, yf, config_folder);
+    return mapPlannerFor(borders, obstacle_list, config_folder).plan(Point(x0,y0), Point(xf,yf));
 }
 
 /** Tries to reduce the number of points in a path by combinaning different techniques.
@@ -2104,7 +3649,8 @@ void drawDebugImage(const Polygon& borders, const vector<Polygon>& obstacle_list
 
 /** Plans a path in which every victim is collected in the correct order.
  * Calls the planning steps for each sub-path in the following order: RRT planner, path smoothing, multi-point
- * dubins curve problem.
+ * dubins curve problem. With DUBINS_RRT (or STATE_LATTICE) the Dubins path is planned directly by a kinodynamic
+ * RRT (or by A* on a state lattice) instead.
  * @param safeBorders safe borders without gate slot (used to prevent RRT bug)
  * @param slotBorders borders with gate slot (used for collision detection)
  * @param obstacle_list List of obstacle polygons.
@@ -2134,6 +3680,41 @@ vector<dubins::Curve> collectVictimsPath(const Polygon& safeBorders,
         pathObjectives.push_back(PUtils::baricenter(victim.second));  //push each victim center
     pathObjectives.push_back(Point(xf,yf));            // push final point
 
+    #if defined(DUBINS_RRT) || defined(STATE_LATTICE)
+    {
+        //
+        // Plan the curvature-feasible path directly (any heading on the victims)
+        //
+        const vector<Point> victims(pathObjectives.begin()+1, pathObjectives.end()-1);
+        try {
+            #ifdef DUBINS_RRT
+                Planning::DubinsRRT::Parameters parameters;
+                parameters.kMax = K_MAX;
+                parameters.step = DUBINS_RRT_STEP;
+                parameters.maxIterations = DUBINS_RRT_MAX_ITERATIONS;
+                parameters.resolution = PATH_RESOLUTION;
+                Planning::DubinsRRT planner(Planning::CollisionChecker(slotBorders, obstacle_list), parameters);
+                vector<dubins::Curve> dubinsPath = planner.planThrough(x, y, theta, victims, xf, yf, thf);
+                #ifdef DEBUG_PLANPATH
+                    cout << "> Dubins RRT: planned " << dubinsPath.size() << " curves (length " << getPathLength(dubinsPath)
+                         << ", " << planner.lastIterations() << " iterations)" << endl;
+                #endif
+            #else
+                Planning::StateLattice& lattice = mapLatticeFor(slotBorders, obstacle_list);
+                vector<dubins::Curve> dubinsPath = lattice.planThrough(x, y, theta, victims, xf, yf, thf);
+                #ifdef DEBUG_PLANPATH
+                    cout << "> State lattice: planned " << dubinsPath.size() << " curves (length " << getPathLength(dubinsPath)
+                         << ", " << lattice.lastExpansions() << " expansions)" << endl;
+                #endif
+            #endif
+            return dubinsPath;
+        } catch (const runtime_error& e) {
+            cout << "Could not plan Dubins path: " << e.what() << endl;
+            return vector<dubins::Curve>();
+        }
+    }
+    #endif
+
     //
     // Call a path planner for each segment to plan
     //
@@ -2147,7 +3728,7 @@ vector<dubins::Curve> collectVictimsPath(const Polygon& safeBorders,
             cout << "Planning segment " << i << "/" << (pathObjectives.size()-1) << endl;
         #endif
         //
-        // PLANNING Step 1: Call RRT planner
+        // PLANNING Step 1: Call the point planner
         //
         float x1,y1,x2,y2;
         x1 = pathObjectives[i-1].x;
@@ -2165,13 +3746,12 @@ vector<dubins::Curve> collectVictimsPath(const Polygon& safeBorders,
             cv::putText(dcImg, "A", pointA, cv::FONT_HERSHEY_DUPLEX, 1.0, cv::Scalar(0,0,255), 2);
             cv::circle(dcImg, pointB, 20, cv::Scalar(0,0,255),4);
             cv::putText(dcImg, "B", pointB, cv::FONT_HERSHEY_DUPLEX, 1.0, cv::Scalar(0,0,255), 2);
-            cv::imshow("Current goal", dcImg);
-            cv::waitKey(0);
+            showDebugImage("Current goal", dcImg);
         #endif
 
-        vector<Point> partialPath = RRTplanner(safeBorders,obstacle_list,x1,y1,x2,y2,config_folder);
+        vector<Point> partialPath = planPointPath(safeBorders,obstacle_list,x1,y1,x2,y2,config_folder);
         full_path.insert(full_path.end(),partialPath.begin()+1,partialPath.end());    // begin()+1 not to repeat points
-        assert(!isPathColliding(partialPath, obstacle_list));  // If the rrt path collides there is an error in the python script or conversion
+        assert(!isPathColliding(partialPath, obstacle_list));  // If the path collides there is an error in the planner or conversion
 
         //
         // PLANNING Step 2: Smoothing/Shortcutting
@@ -2184,7 +3764,7 @@ vector<dubins::Curve> collectVictimsPath(const Polygon& safeBorders,
 
     #ifdef DEBUG_PLANPATH
         cout << "------------------------------------------------------------" << endl;
-        cout << "> Planning Step 1: planned RRT path ("<< full_path.size() <<" steps)" << endl;
+        cout << "> Planning Step 1: planned point path ("<< full_path.size() <<" steps)" << endl;
         cout << "------------------------------------------------------------" << endl;
         cout << "> Planning Step 2: smoothed path ("<< short_path.size() <<" steps)" << endl;
         cout << "------------------------------------------------------------" << endl;
@@ -2193,8 +3773,7 @@ vector<dubins::Curve> collectVictimsPath(const Polygon& safeBorders,
     #ifdef DEBUG_DRAWCURVE
         drawDebugImage(slotBorders, obstacle_list, victim_list);
         drawDebugPath(short_path);
-        cv::imshow("Curves",dcImg);
-        cv::waitKey(0);
+        showDebugImage("Curves",dcImg);
     #endif
 
     //
@@ -2318,31 +3897,13 @@ vector<dubins::Curve> collectVictimsPath(const Polygon& safeBorders,
         }
 
         //cv::flip(dcImg, dcImg, 0);
-        cv::imshow("Curves",dcImg);
-        cv::waitKey(0);
+        showDebugImage("Curves",dcImg);
 
     #endif
 
     return multipointPath;
 }
 
-/** Computes the length of a path of points.
- * @param path Input path points.
- * @return The legth of the path.
-*/
-float getPointPathLength(const vector<Point>& path){
-    float length = 0;
-
-    for (size_t i = 0; i < path.size()-1; i++)
-    {
-        const Point pos1 = path[i];
-        const Point pos2 = path[i+1];
-        length += sqrt(pow((pos1.x - pos2.x), 2) + pow((pos1.y - pos2.y), 2));
-    }
-
-    return length;
-}
-
 /** Computes the length of a path of poses.
  * @param path Input path poses.
  * @return The legth of the path.
@@ -2372,7 +3933,8 @@ bool sorByDistance(const pair<int,float>& p1, const pair<int,float>& p2){
 /** Plans a path that maximizes the time-score of the mission.
  * For each victim collected a time-bonus is granted. At each step, the greedy function picks the victim
  * that better improves the final score. To avoid robot loops and improve the search, the victims to test are ordered by
- * distance from the starting point.
+ * distance from the starting point. With DISTANCE_FIELD the distances come from grid wavefront fields, which also skip
+ * the victims whose shortest possible path cannot improve the score.
  * @param safeBorders safe borders without gate slot (used to prevent RRT bug)
  * @param slotBorders borders with gate slot (used for collision detection)
  * @param obstacle_list List of obstacle polygons.
@@ -2404,15 +3966,47 @@ vector<dubins::Curve> bestScoreGreedy(const Polygon& safeBorders,
     // compute victim distance from start
     vector<float> distances;
 
-    for (size_t i = 0; i < victim_list.size(); i++)
-    {
-        vector<Point> path = RRTplanner(safeBorders,obstacle_list,x,y,PUtils::baricenter(victim_list[i].second).x,PUtils::baricenter(victim_list[i].second).y,config_folder);
-        assert(!isPathColliding(path, obstacle_list));  // If the rrt path collides there is an error in the python script or conversion
+    vector<Point> centers;
+    for (const pair<int,Polygon>& victim : victim_list)
+        centers.push_back(PUtils::baricenter(victim.second));
+
+    #ifdef DISTANCE_FIELD
+    // wavefront distances from the start (source 0), from every victim
+    // (source 1+i) and from the gate (last source)
+    vector<Point> sources = {Point(x,y)};
+    sources.insert(sources.end(), centers.begin(), centers.end());
+    sources.push_back(Point(xf,yf));
+    const size_t gateSource = sources.size() - 1;
+    // obstacle cells rasterized once per map (see prepareObstacleGeometry)
+    shared_future<ObstacleGeometry> geometry = obstacleGeometryFor(obstacle_list);
+    Planning::DistanceField field(safeBorders, *geometry.get().fieldRaster);
+    field.compute(sources);
+    for (const Point& center : centers) {
+        const float length = field.distance(0, center);
+        if (std::isinf(length))
+            throw runtime_error("Path not found!");
+        distances.push_back(length);
+    }
+    #else
+    if (POINT_PLANNER != PlannerBackend::rrt) {
+        // roadmap planners search once for all the victims
+        for (double length : mapPlannerFor(safeBorders, obstacle_list, config_folder).distancesFrom(Point(x,y), centers)) {
+            if (std::isinf(length))
+                throw runtime_error("Path not found!");
+            distances.push_back(length);
+        }
+    } else {
+        for (size_t i = 0; i < victim_list.size(); i++)
+        {
+            vector<Point> path = RRTplanner(safeBorders,obstacle_list,x,y,PUtils::baricenter(victim_list[i].second).x,PUtils::baricenter(victim_list[i].second).y,config_folder);
+            assert(!isPathColliding(path, obstacle_list));  // If the rrt path collides there is an error in the python script or conversion
 
-        float length = getPointPathLength(path);
+            float length = getPointPathLength(path);
 
-        distances.push_back(length);
+            distances.push_back(length);
+        }
     }
+    #endif
 
     // no victim path
     vector<bool> collected;
@@ -2461,6 +4055,22 @@ vector<dubins::Curve> bestScoreGreedy(const Polygon& safeBorders,
                     temp_victim_list.push_back(victim_list[temp_ordered_distances[i].first]);
                 }
 
+                #ifdef DISTANCE_FIELD
+                    // skip the victim if even the shortest point path cannot beat the best score
+                    // (an unreachable gate cell gives no bound: the path is planned anyway)
+                    float lowerBound = field.lowerBound(0, centers[temp_ordered_distances.front().first]);
+                    for (size_t i = 1; i < temp_ordered_distances.size(); i++)
+                        lowerBound += field.lowerBound(1 + temp_ordered_distances[i-1].first, centers[temp_ordered_distances[i].first]);
+                    lowerBound += field.lowerBound(gateSource, centers[temp_ordered_distances.back().first]);
+                    if (!std::isinf(lowerBound) && ((lowerBound / ROBOT_SPEED) - (bonus * bonus_multiplier) >= best_partial_time)) {
+                        #ifdef DEBUG_SCORES
+                            cout << "Skipping victim " << victim_list[j].first << ". Time-score at least: "
+                                 << (lowerBound / ROBOT_SPEED) - (bonus * bonus_multiplier) << endl;
+                        #endif
+                        continue;
+                    }
+                #endif
+
                 #ifdef DEBUG_PLANPATH
                         cout << "Testing with victim " << victim_list[j].first << endl;
                 #endif